@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../module/random/main.hpp"
+#include "../header/storage.hpp"
+
+// compression ratio and throughput of the checkpoint formats on synthetic genomes
+// usage: compression [networks] [neurons per hidden layer] [synapses per neuron] [file]
+// throughput is counted in bytes of the plain format, so the columns compare directly
+
+std::vector<Storage::Genome> synthesize(const int networks, const int width, const int synapses) {
+    const std::vector<int> sizes = { 16, width, width, 4 };
+
+    std::vector<Storage::Genome> genomes(networks);
+    for (int i = 0; i < networks; i++) {
+        auto& genome = genomes[i];
+        genome.index = i;
+        genome.layers.resize(sizes.size());
+
+        for (int depth = 0; depth < static_cast<int>(sizes.size()); depth++)
+            for (int height = 0; height < sizes[depth]; height++) {
+                auto& neuron = genome.layers[depth].emplace_back(Storage::Genome::Neuron{ Random::generate(-1.0, 1.0), { } });
+                if (depth == 0)
+                    continue;
+
+                // mostly the previous layer, like networks grown by Network::evolve
+                for (int s = 0; s < synapses; s++) {
+                    const int d = Random::generate(0.0, 1.0) < 0.8 ? depth - 1 : Random::generate<int>(0, depth, true, false);
+                    const int h = Random::generate<int>(0, sizes[d], true, false);
+                    double weight = Random::generate(-1.0, 1.0);
+                    if (Random::generate(0.0, 1.0) < 0.1) // clamped at the range
+                        weight = weight < 0 ? -1.0 : 1.0;
+
+                    const bool taken = std::any_of(neuron.synapses.begin(), neuron.synapses.end(), [d, h](const auto& synapse) {
+                        return synapse.depth == d && synapse.height == h;
+                    });
+                    if (!taken)
+                        neuron.synapses.push_back({ d, h, weight });
+                }
+            }
+    }
+    return genomes;
+};
+
+double error(const Storage::Genome& a, const Storage::Genome& b) {
+    double worst = 0;
+    for (std::size_t depth = 0; depth < a.layers.size(); depth++)
+        for (std::size_t height = 0; height < a.layers[depth].size(); height++) {
+            const auto& x = a.layers[depth][height];
+            const auto& y = b.layers[depth][height];
+            worst = std::max(worst, std::abs(x.bias - y.bias));
+
+            for (const auto& synapse : x.synapses)
+                for (const auto& other : y.synapses)
+                    if (synapse.depth == other.depth && synapse.height == other.height)
+                        worst = std::max(worst, std::abs(synapse.weight - other.weight));
+        }
+    return worst;
+};
+
+int main(int argc, char** argv) {
+    const int networks = argc > 1 ? std::stoi(argv[1]) : 200;
+    const int width = argc > 2 ? std::stoi(argv[2]) : 64;
+    const int synapses = argc > 3 ? std::stoi(argv[3]) : 16;
+    const std::string path = argc > 4 ? argv[4] : "compression.bin";
+
+    Random::seed(1);
+    const auto genomes = synthesize(networks, width, synapses);
+
+    struct Format {
+        const char* name;
+        std::uint16_t flags;
+    };
+    const Format formats[] = { { "plain", 0 }, { "compact", Storage::COMPACT }, { "float32", Storage::FLOAT32 } };
+
+    using Clock = std::chrono::steady_clock;
+    double plain = 0;
+
+    std::printf("%-8s %12s %7s %12s %12s %10s\n", "format", "bytes", "ratio", "encode MB/s", "decode MB/s", "max error");
+    for (const auto& format : formats) {
+        const auto start = Clock::now();
+        std::size_t bytes;
+        {
+            Storage::Writer writer(path);
+            std::vector<char> scratch;
+            for (const auto& genome : genomes)
+                Storage::record(writer, genome, scratch, format.flags);
+            writer.close();
+            bytes = writer.size();
+        }
+        const double encode = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (plain == 0)
+            plain = bytes;
+
+        const Storage::Mapping mapping(path);
+        Storage::Reader reader(mapping.data(), mapping.size());
+
+        std::vector<Storage::Genome> decoded;
+        decoded.reserve(genomes.size());
+
+        const auto begin = Clock::now();
+        for (std::size_t i = 0; i < genomes.size(); i++) {
+            const auto size = reader.fixed<std::uint32_t>();
+            decoded.push_back(Storage::decode(reader.skip(size), size, format.flags));
+        }
+        const double decode = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        double worst = 0;
+        for (std::size_t i = 0; i < genomes.size(); i++)
+            worst = std::max(worst, error(genomes[i], decoded[i]));
+
+        std::printf("%-8s %12zu %7.3f %12.1f %12.1f %10.3g\n", format.name, bytes, plain / bytes, plain / encode / 1e+6, plain / decode / 1e+6, worst);
+    }
+
+    std::remove(path.c_str());
+}
\ No newline at end of file
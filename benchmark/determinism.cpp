@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../module/random/main.hpp"
+#include "../header/population.hpp"
+
+#include "probe.hpp"
+
+// checks that a seeded population trains and evolves bit for bit the same on one thread and on many
+// usage: determinism [--generations n] [--size n] [--threads n] [--backend interpreted|compiled]
+// every generation trains in two calls, which must not replay each other's streams;
+// exits with 1 when they do, or when any fitness or journal differs between the runs
+
+const int GROUP = 2; // networks per group, so indices are flattened as the Recorder does
+std::vector<std::vector<double>> expected; // per network, the answer to the last input it was sent
+std::vector<std::vector<double>> sent; // per network, its first inputs this generation
+
+int flat(const NetworkIndex n) { return n.group * GROUP + n.index; };
+
+std::vector<double> send(const NetworkIndex n) {
+    const double a = Random::generate(-1.0, 1.0), b = Random::generate(-1.0, 1.0);
+    expected[flat(n)] = { a * b > 0 ? 1.0 : 0.0 };
+    sent[flat(n)].push_back(a);
+    return { a, b };
+};
+double fit(const NetworkIndex n, std::vector<double> output) {
+    return 1 - std::abs((output.empty() ? 0 : output[0]) - expected[flat(n)][0]);
+};
+
+struct Generation {
+    std::vector<double> first, second; // fitness after each train call
+    std::vector<std::vector<Network::Mutation>> journals; // of the children evolve made
+    bool replayed = true; // the second call sent every network what the first did
+};
+
+std::vector<Generation> run(const Configuration::Network::Backend backend, const int size, const int generations, const int threads) {
+    Configuration config(2, 1);
+    config.population.size = size;
+    config.population.group = GROUP;
+    config.population.threads = threads;
+    config.population.seed = 1;
+    config.network.backend = backend;
+
+    expected.assign(size, { 0.0 });
+    sent.assign(size, { });
+    Population population(config);
+    population.sender(send);
+    population.trainer(fit);
+    population.start();
+
+    auto fitness = [&population] {
+        std::vector<double> fits;
+        for (const auto& network : benchmark::Probe::networks(population))
+            fits.push_back(network.get_fitness());
+        return fits;
+    };
+
+    std::vector<Generation> runs(generations);
+    for (auto& g : runs) {
+        for (auto& inputs : sent)
+            inputs.clear();
+        population.train(3);
+        g.first = fitness();
+        population.train(3);
+        g.second = fitness();
+
+        for (const auto& inputs : sent) {
+            const std::size_t half = inputs.size() / 2;
+            g.replayed = g.replayed && std::equal(inputs.begin(), inputs.begin() + half, inputs.begin() + half);
+        }
+
+        population.evolve();
+        for (const auto& network : benchmark::Probe::networks(population))
+            g.journals.push_back(network.get_journal());
+    }
+    return runs;
+};
+
+bool same(const Network::Mutation& a, const Network::Mutation& b) {
+    return a.kind == b.kind && a.depth == b.depth && a.height == b.height
+        && a.sourceDepth == b.sourceDepth && a.sourceHeight == b.sourceHeight
+        && a.value == b.value && a.previous == b.previous;
+};
+int compare(const std::vector<double>& a, const std::vector<double>& b) {
+    int differ = a.size() != b.size();
+    for (std::size_t i = 0; i < std::min(a.size(), b.size()); i++)
+        differ += a[i] != b[i];
+    return differ;
+};
+
+int main(int argc, char** argv) {
+    int generations = 5, size = 40, threads = 64;
+    auto backend = Configuration::Network::Interpreted;
+
+    for (int i = 1; i < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+            throw std::invalid_argument("determinism: missing value for "+arg+".");
+
+        const std::string value = argv[i + 1];
+        if (arg == "--generations")
+            generations = std::stoi(value);
+        else if (arg == "--size")
+            size = std::stoi(value);
+        else if (arg == "--threads")
+            threads = std::stoi(value);
+        else if (arg == "--backend") {
+            if (value == "interpreted")
+                backend = Configuration::Network::Interpreted;
+            else if (value == "compiled")
+                backend = Configuration::Network::Compiled;
+            else
+                throw std::invalid_argument("determinism: unknown backend "+value+".");
+        } else
+            throw std::invalid_argument("determinism: unknown option "+arg+".");
+    }
+    if (generations <= 0 || size <= 0 || size % GROUP != 0 || threads <= 1)
+        throw std::invalid_argument("determinism: generations must be positive, size a multiple of the group and threads above 1.");
+
+    std::vector<Generation> single, many;
+    try {
+        single = run(backend, size, generations, 1);
+        many = run(backend, size, generations, threads);
+    } catch (const std::exception& e) { // a seeded failure repeats every run, report it rather than abort
+        std::printf("failed: %s\n", e.what());
+        return 1;
+    }
+
+    int failures = 0;
+    std::printf("%-10s %10s %10s %10s\n", "generation", "fitness", "journals", "repeated");
+    for (int g = 0; g < generations; g++) {
+        const Generation& a = single[g];
+        const Generation& b = many[g];
+
+        const int fitness = compare(a.first, b.first) + compare(a.second, b.second);
+        int journals = a.journals.size() != b.journals.size();
+        for (std::size_t i = 0; i < std::min(a.journals.size(), b.journals.size()); i++) {
+            bool equal = a.journals[i].size() == b.journals[i].size();
+            for (std::size_t m = 0; equal && m < a.journals[i].size(); m++)
+                equal = same(a.journals[i][m], b.journals[i][m]);
+            journals += !equal;
+        }
+
+        failures += fitness + journals + a.replayed;
+        std::printf("%-10d %10d %10d %10s\n", g, fitness, journals, a.replayed ? "yes" : "no");
+    }
+
+    std::printf("%s: 1 and %d threads, %d generations of %d networks\n", failures == 0 ? "identical" : "diverged", threads, generations, size);
+    return failures > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../module/random/main.hpp"
+#include "../header/population.hpp"
+
+#include "probe.hpp"
+
+// checks that structural mutations keep a dynamic network well formed, starting from no hidden layers
+// usage: evolution [--generations n] [--size n]
+// layers are added at the highest rate Random::log accepts and never removed; exits with 1 when evolve throws,
+// when a network loses its input or output layer, or when no network ever grows a hidden layer
+
+const int INPUTS = 2, OUTPUTS = 1;
+
+int main(int argc, char** argv) {
+    int generations = 5, size = 40;
+
+    for (int i = 1; i < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+            throw std::invalid_argument("evolution: missing value for "+arg+".");
+
+        const std::string value = argv[i + 1];
+        if (arg == "--generations")
+            generations = std::stoi(value);
+        else if (arg == "--size")
+            size = std::stoi(value);
+        else
+            throw std::invalid_argument("evolution: unknown option "+arg+".");
+    }
+    if (generations <= 0 || size <= 0)
+        throw std::invalid_argument("evolution: generations and size must be positive.");
+
+    Configuration config(INPUTS, OUTPUTS);
+    config.population.size = size;
+    config.population.seed = 1;
+    config.mutate.layer.add.rate = 0.5; // Random::log takes rates in [0, 1), half of the draws add a layer
+    config.mutate.layer.remove.rate = 0;
+
+    Population population(config);
+    population.sender([](NetworkIndex) { return std::vector<double>{ Random::generate(-1.0, 1.0), Random::generate(-1.0, 1.0) }; });
+    population.trainer([](NetworkIndex, std::vector<double> output) { return output.empty() ? 0.0 : output[0]; });
+    population.start();
+
+    int failures = 0, deepest = 2;
+    std::printf("%-10s %10s %10s\n", "generation", "deepest", "malformed");
+    for (int g = 0; g < generations; g++) {
+        try {
+            population.train(1);
+            population.evolve();
+        } catch (const std::exception& e) {
+            std::printf("%-10d evolve threw: %s\n", g, e.what());
+            return 1;
+        }
+
+        int malformed = 0;
+        for (const auto& network : benchmark::Probe::networks(population)) {
+            const Genome& genome = network.get_genome();
+            const int layers = genome.get_size();
+            malformed += layers < 2 || genome.get_size(0) != INPUTS || genome.get_size(layers - 1) != OUTPUTS;
+            deepest = std::max(deepest, layers);
+        }
+        failures += malformed;
+        std::printf("%-10d %10d %10d\n", g, deepest, malformed);
+    }
+    failures += deepest == 2;
+
+    std::printf("%s: %d generations of %d networks, at most %d layers\n", failures == 0 ? "well formed" : "malformed", generations, size, deepest);
+    return failures > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "../module/random/main.hpp"
+#include "../module/trace/main.hpp"
+#include "../header/population.hpp"
+
+#include "probe.hpp"
+
+// end-to-end throughput on canonical workloads: start, then per generation compile (compiled backend), train and evolve
+// usage: macro [--filter text] [--generations n] [--sizes 50,200] [--backends interpreted,compiled]
+//              [--json path] [--baseline path|none] [--threshold fraction] [--trace path]
+// exits with 1 when a run is slower, or peaks higher in memory, than the baseline by more than the threshold;
+// the baseline defaults to the committed reference results, BASELINE below, read from the repository root;
+// a run it has no entry for fails too, so record one on the reference machine with --json BASELINE
+// or pass --baseline none to skip the gate
+// peak rss is the process high-water mark, run one workload per process with --filter to isolate it
+// --trace writes a chrome trace of the runs when built with -DTRACING
+
+namespace task {
+    std::vector<std::vector<double>> expected; // per network, the answer to the last input it was sent
+    struct Cart { double x, v, theta, omega; };
+    std::vector<Cart> carts;
+
+    int group = 1; // networks per group, as configured
+    int flat(const NetworkIndex n) { return n.group * group + n.index; };
+
+    double bit() { return Random::generate<int>(0, 2, true, false); };
+    double score(const NetworkIndex n, const std::vector<double>& output) { // 1 for an exact answer, 0 at the opposite end
+        const auto& answer = expected[flat(n)];
+        double error = 0;
+        for (std::size_t i = 0; i < answer.size(); i++)
+            error += std::abs((i < output.size() ? output[i] : 0) - answer[i]);
+        return std::max(0.0, 1 - error / answer.size());
+    };
+
+    std::vector<double> xor_input(const NetworkIndex n) {
+        const double a = bit(), b = bit();
+        expected[flat(n)] = { a != b ? 1.0 : 0.0 };
+        return { a, b };
+    };
+
+    const int BITS = 4;
+    std::vector<double> parity_input(const NetworkIndex n) {
+        std::vector<double> bits(BITS);
+        int ones = 0;
+        for (auto& b : bits)
+            ones += (b = bit()) != 0;
+        expected[flat(n)] = { ones % 2 == 1 ? 1.0 : 0.0 };
+        return bits;
+    };
+
+    std::vector<double> sine_input(const NetworkIndex n) {
+        const double x = Random::generate(-M_PI, M_PI);
+        expected[flat(n)] = { (std::sin(x) + 1) / 2 }; // sigmoid outputs live in [0, 1]
+        return { x / M_PI };
+    };
+    double fit(const NetworkIndex n, std::vector<double> output) { return score(n, output); };
+
+    // classic cart-pole, one euler step of 20ms per evaluation, rewarded while the pole stays up
+    Cart drop() { return { Random::generate(-0.05, 0.05), Random::generate(-0.05, 0.05), Random::generate(-0.05, 0.05), Random::generate(-0.05, 0.05) }; };
+    std::vector<double> cart_input(const NetworkIndex n) {
+        const Cart& c = carts[flat(n)];
+        return { c.x / 2.4, c.v / 2, c.theta / 0.21, c.omega / 2 };
+    };
+    double cart_fit(const NetworkIndex n, std::vector<double> output) {
+        Cart& c = carts[flat(n)];
+        const double force = !output.empty() && output[0] > 0.5 ? 10 : -10;
+        const double gravity = 9.8, cart = 1.0, pole = 0.1, length = 0.5, tau = 0.02;
+
+        const double cos = std::cos(c.theta), sin = std::sin(c.theta);
+        const double temp = (force + pole * length * c.omega * c.omega * sin) / (cart + pole);
+        const double alpha = (gravity * sin - cos * temp) / (length * (4.0 / 3 - pole * cos * cos / (cart + pole)));
+        const double accel = temp - pole * length * alpha * cos / (cart + pole);
+
+        c.x += tau * c.v, c.v += tau * accel;
+        c.theta += tau * c.omega, c.omega += tau * alpha;
+
+        if (std::abs(c.x) > 2.4 || std::abs(c.theta) > 0.21) {
+            c = drop();
+            return 0;
+        }
+        return 1;
+    };
+
+    void reset(const int size) {
+        expected.assign(size, { });
+        carts.assign(size, { });
+        for (auto& c : carts)
+            c = drop();
+    };
+}
+
+struct Task {
+    std::string name;
+    int inputs, outputs;
+    int iterations; // evaluations per network per generation
+    InputFunction sender;
+    FitnessFunction trainer;
+};
+const std::vector<Task> TASKS = {
+    { "xor", 2, 1, 4, task::xor_input, task::fit },
+    { "parity", task::BITS, 1, 16, task::parity_input, task::fit },
+    { "sine", 1, 1, 16, task::sine_input, task::fit },
+    { "cartpole", 4, 1, 200, task::cart_input, task::cart_fit }
+};
+
+const std::string BASELINE = "benchmark/macro.json";
+
+struct Result {
+    std::string name; // task/backend/size
+    double start = 0, compile = 0, train = 0, evolve = 0; // seconds
+    double generations = 0, evaluations = 0; // per second
+    double rss = 0; // peak, in megabytes
+};
+
+double peak() { // megabytes
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1048576.0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1048576.0; // bytes
+#else
+    return usage.ru_maxrss / 1024.0; // kilobytes
+#endif
+#endif
+};
+
+Result run(const Task& t, const Configuration::Network::Backend backend, const int size, const int generations) {
+    using Clock = std::chrono::steady_clock;
+    auto since = [](const Clock::time_point from) { return std::chrono::duration<double>(Clock::now() - from).count(); };
+
+    Configuration config(t.inputs, t.outputs);
+    config.population.size = size;
+    config.population.seed = 1;
+    config.network.backend = backend;
+
+    task::group = config.population.group;
+    task::reset(size);
+    Population population(config);
+    population.sender(t.sender);
+    population.trainer(t.trainer);
+
+    Result result{ t.name+"/"+(backend == Configuration::Network::Compiled ? "compiled" : "interpreted")+"/"+std::to_string(size) };
+
+    auto clock = Clock::now();
+    population.start();
+    result.start = since(clock);
+
+    for (int g = 0; g < generations; g++) {
+        if (backend == Configuration::Network::Compiled) {
+            clock = Clock::now();
+            benchmark::Probe::compile(population);
+            result.compile += since(clock);
+        }
+
+        clock = Clock::now();
+        population.train(t.iterations);
+        result.train += since(clock);
+
+        clock = Clock::now();
+        population.evolve();
+        result.evolve += since(clock);
+    }
+
+    const double total = result.start + result.compile + result.train + result.evolve;
+    result.generations = generations / total;
+    result.evaluations = population.evaluations() / result.train;
+    result.rss = peak();
+    return result;
+};
+
+std::vector<std::string> split(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    for (std::string part; std::getline(stream, part, ','); )
+        if (!part.empty())
+            parts.push_back(part);
+    return parts;
+};
+
+void write(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("macro: could not open "+path+".");
+
+    out << "{\n    \"results\": [";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "        { \"name\": \"" << r.name << "\""
+            << ", \"start\": " << r.start << ", \"compile\": " << r.compile << ", \"train\": " << r.train << ", \"evolve\": " << r.evolve
+            << ", \"generations\": " << r.generations << ", \"evaluations\": " << r.evaluations << ", \"rss\": " << r.rss << " }";
+    }
+    out << "\n    ]\n}\n";
+};
+std::map<std::string, Result> read(const std::string& path) { // one result per line, as written above
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("macro: could not open baseline "+path+".");
+
+    auto field = [](const std::string& line, const std::string& key) {
+        const auto at = line.find("\""+key+"\":");
+        if (at == std::string::npos)
+            throw std::runtime_error("macro: baseline entry without "+key+".");
+        return std::stod(line.substr(at + key.size() + 3));
+    };
+
+    std::map<std::string, Result> results;
+    for (std::string line; std::getline(in, line); ) {
+        const auto at = line.find("\"name\": \"");
+        if (at == std::string::npos)
+            continue;
+
+        const auto begin = at + 9, end = line.find('"', begin);
+        Result r{ line.substr(begin, end - begin) };
+        r.generations = field(line, "generations");
+        r.evaluations = field(line, "evaluations");
+        r.rss = field(line, "rss");
+        results.insert_or_assign(r.name, r);
+    }
+    return results;
+};
+
+int main(int argc, char** argv) {
+    std::string filter = "", json = "", baseline = BASELINE, trace = "";
+    int generations = 20;
+    double threshold = 0.1;
+    std::vector<int> sizes = { 50, 200 };
+    std::vector<Configuration::Network::Backend> backends = { Configuration::Network::Interpreted };
+
+    for (int i = 1; i < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+            throw std::invalid_argument("macro: missing value for "+arg+".");
+
+        const std::string value = argv[i + 1];
+        if (arg == "--filter")
+            filter = value;
+        else if (arg == "--generations")
+            generations = std::stoi(value);
+        else if (arg == "--sizes") {
+            sizes.clear();
+            for (const auto& size : split(value))
+                sizes.push_back(std::stoi(size));
+        } else if (arg == "--backends") {
+            backends.clear();
+            for (const auto& backend : split(value))
+                if (backend == "interpreted")
+                    backends.push_back(Configuration::Network::Interpreted);
+                else if (backend == "compiled")
+                    backends.push_back(Configuration::Network::Compiled);
+                else
+                    throw std::invalid_argument("macro: unknown backend "+backend+".");
+        } else if (arg == "--json")
+            json = value;
+        else if (arg == "--baseline")
+            baseline = value;
+        else if (arg == "--threshold")
+            threshold = std::stod(value);
+        else if (arg == "--trace")
+            trace = value;
+        else
+            throw std::invalid_argument("macro: unknown option "+arg+".");
+    }
+    if (generations <= 0 || threshold < 0)
+        throw std::invalid_argument("macro: generations and threshold must be positive.");
+
+    std::vector<Result> results;
+    std::printf("%-28s %9s %9s %9s %9s %10s %12s %9s\n", "run", "start s", "compile s", "train s", "evolve s", "gens/s", "evals/s", "rss MB");
+    for (const auto& t : TASKS)
+        for (const auto backend : backends)
+            for (const int size : sizes) {
+                const std::string name = t.name+"/"+(backend == Configuration::Network::Compiled ? "compiled" : "interpreted")+"/"+std::to_string(size);
+                if (name.find(filter) == std::string::npos)
+                    continue;
+
+                const Result& r = results.emplace_back(run(t, backend, size, generations));
+                std::printf("%-28s %9.3f %9.3f %9.3f %9.3f %10.2f %12.0f %9.1f\n", r.name.c_str(), r.start, r.compile, r.train, r.evolve, r.generations, r.evaluations, r.rss);
+                std::fflush(stdout);
+            }
+
+    if (!json.empty())
+        write(json, results);
+    if (!trace.empty())
+        Trace::dump(trace);
+    if (baseline == "none")
+        return 0;
+
+    int regressions = 0, unchecked = 0;
+    const auto base = read(baseline);
+    for (const auto& r : results) {
+        const auto it = base.find(r.name);
+        if (it == base.end()) { // a gate that skips what it cannot compare would pass anything
+            std::printf("unchecked: %s has no baseline entry\n", r.name.c_str());
+            unchecked++;
+            continue;
+        }
+
+        const Result& b = it->second;
+        auto check = [&regressions, &r, threshold](const char* metric, const double now, const double then, const bool higher) {
+            const double change = then == 0 ? 0 : (now - then) / then;
+            if (higher ? change < -threshold : change > threshold) {
+                std::printf("regression: %s %s %.3g -> %.3g (%+.1f%%)\n", r.name.c_str(), metric, then, now, 100 * change);
+                regressions++;
+            }
+        };
+        check("gens/s", r.generations, b.generations, true);
+        check("evals/s", r.evaluations, b.evaluations, true);
+        check("rss MB", r.rss, b.rss, false);
+    }
+    std::printf("%d regression%s against %s, %d of %zu runs had no baseline\n", regressions, regressions == 1 ? "" : "s", baseline.c_str(), unchecked, results.size());
+    return regressions > 0 || unchecked > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include <array>
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../module/bench/main.hpp"
+#include "../module/random/main.hpp"
+#include "../module/registry/main.hpp"
+#include "../resource/compiler/.hpp"
+#include "../header/population.hpp"
+#include "../header/static.hpp"
+#include "../header/storage.hpp"
+
+#include "probe.hpp"
+
+// microbenchmarks of the engine's hot paths, per network and population size
+// usage: micro [--filter text] [--json path] [--time seconds] [--repetitions n]
+// times are per item: per network for network cases, per value or id otherwise
+// built with -mavx2 -mfma (the "micro (AVX2)" task) the sparse evaluator cases time the gather path,
+// compare them against the plain build for its speedup
+
+const std::vector<long long> WIDTHS = { 16, 64, 256 }; // neurons per hidden layer
+const std::vector<long long> SIZES = { 10, 100 }; // networks per population
+const std::vector<long long> DENSITIES = { 1, 5, 25, 100 }; // percent of the earlier neurons feeding a sparse neuron
+const int INPUTS = 16, OUTPUTS = 4, SYNAPSES = 8; // synapses per neuron, from the layer before
+
+Configuration configure(const int width, const int size) {
+    Configuration config(INPUTS, OUTPUTS, std::vector<const int>{ width, width });
+    config.population.size = size;
+    config.population.seed = 1;
+    return config;
+};
+
+void grow(Network& network) { // fresh networks have no synapses, evolved ones mostly read the layer before
+    Genome genome = network.get_genome();
+    for (int depth = 1; depth < genome.get_size(); depth++)
+        for (int height = 0; height < genome.get_size(depth); height++)
+            for (int s = 0; s < SYNAPSES; s++) {
+                const int source = Random::generate<int>(0, genome.get_size(depth - 1), true, false);
+                genome.add_synapse(depth, height, genome.get_neuron(depth - 1, source).id, Random::generate(-1.0, 1.0));
+            }
+    network.set_genome(genome);
+};
+
+void spread(Network& network, const double density) { // skip-layer synapses as evolve grows them, from any earlier layer
+    Genome genome = network.get_genome();
+    std::vector<std::tuple<int, int>> earlier;
+    for (int depth = 1; depth < genome.get_size(); depth++) {
+        for (int height = 0; height < genome.get_size(depth - 1); height++)
+            earlier.push_back({ depth - 1, height });
+        for (int height = 0; height < genome.get_size(depth); height++)
+            for (const auto i : Random::sample(earlier.size(), density)) {
+                const auto [ d, h ] = earlier[i];
+                genome.add_synapse(depth, height, genome.get_neuron(d, h).id, Random::generate(-1.0, 1.0));
+            }
+    }
+    network.set_genome(genome);
+};
+
+struct Fixture { // one at a time: every population compiles into the same folder
+    Population population;
+    std::vector<Network>& networks;
+
+    Fixture(Bench::State& state, const bool sparse = false) :
+        population(configure(state.get("width"), state.get("population"))),
+        networks(benchmark::Probe::networks(population)) {
+            population.start();
+            for (auto& network : networks)
+                sparse ? spread(network, state.get("density") / 100.0) : grow(network);
+            state.items(networks.size());
+        };
+};
+
+template <int Width>
+void shaped(Bench& bench) { // a shape is a template argument, so one case per width
+    bench.grid("StaticNetwork::evaluate", { { "width", { Width } }, { "population", SIZES } }, [](Bench::State& state) {
+        Fixture fixture(state);
+        std::vector<StaticNetwork<StaticActivator::Sigmoid, INPUTS, OUTPUTS, Width, Width>> networks;
+        for (const auto& network : fixture.networks)
+            networks.emplace_back(network);
+        std::array<double, INPUTS> inputs;
+        Random::fill(inputs, Range<double>(1.0));
+
+        state.run([&networks, &inputs] {
+            for (const auto& network : networks)
+                Bench::keep(network.evaluate(inputs));
+        });
+    });
+};
+
+int main(int argc, char** argv) {
+    Random::seed(1);
+    Bench bench(argc, argv);
+    const std::vector<std::tuple<std::string, std::vector<long long>>> grid = { { "width", WIDTHS }, { "population", SIZES } };
+
+    bench.grid("Network::init", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        state.run([&fixture] {
+            for (auto& network : fixture.networks)
+                network.init();
+        });
+    });
+    bench.grid("Network::clone_from", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        std::vector<Network> children;
+        for (int i = 0; i < static_cast<int>(fixture.networks.size()); i++)
+            children.push_back(benchmark::Probe::make(fixture.population, i));
+
+        state.run([&fixture, &children] {
+            for (std::size_t i = 0; i < children.size(); i++)
+                children[i].clone_from(fixture.networks[i]);
+        });
+    });
+    bench.grid("Network::evolve", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        std::vector<Network> children;
+        for (int i = 0; i < static_cast<int>(fixture.networks.size()); i++)
+            children.push_back(benchmark::Probe::make(fixture.population, i));
+
+        state.run([&fixture, &children] { // mutations would pile up without a fresh clone
+            for (std::size_t i = 0; i < children.size(); i++)
+                children[i].clone_from(fixture.networks[i]);
+        }, [&children] {
+            for (auto& child : children)
+                child.evolve();
+        });
+    });
+    bench.grid("Network::update", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        for (const auto& network : fixture.networks)
+            network.prime();
+
+        state.run([&fixture] {
+            for (const auto& network : fixture.networks)
+                benchmark::Probe::update(network);
+        });
+    });
+    bench.grid("Network::get_code", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        for (const auto& network : fixture.networks) {
+            network.prime();
+            benchmark::Probe::update(network);
+        }
+
+        state.run([&fixture] {
+            for (const auto& network : fixture.networks)
+                Bench::keep(network.get_code());
+        });
+    });
+
+    // the interpreted backend over the same genomes, general graph against the fixed-topology matrices
+    bench.grid("Evaluator::evaluate", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        std::vector<Evaluator> evaluators;
+        for (const auto& network : fixture.networks)
+            evaluators.emplace_back(network.get_genome(), ActivatorSearch::function("sigmoid"));
+        std::vector<double> inputs(INPUTS);
+        Random::fill(inputs, Range<double>(1.0));
+
+        state.run([&evaluators, &inputs] {
+            for (const auto& evaluator : evaluators)
+                Bench::keep(evaluator.evaluate(inputs));
+        });
+    });
+    bench.grid("Dense::evaluate", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        std::vector<Dense> matrices;
+        for (const auto& network : fixture.networks)
+            matrices.emplace_back(network.get_genome(), ActivatorSearch::function("sigmoid"));
+        std::vector<double> inputs(INPUTS);
+        Random::fill(inputs, Range<double>(1.0));
+
+        state.run([&matrices, &inputs] {
+            for (const auto& dense : matrices)
+                Bench::keep(dense.evaluate(inputs));
+        });
+    });
+    bench.grid("Tensor::evaluate", grid, [](Bench::State& state) { // per network and input, comparable to the above
+        Fixture fixture(state);
+        std::vector<const Dense*> matrices;
+        for (auto& network : fixture.networks)
+            matrices.push_back(&network.get_dense());
+        const Tensor tensor(matrices, ActivatorSearch::function("sigmoid"));
+
+        std::vector<std::vector<double>> inputs(16, std::vector<double>(INPUTS));
+        for (auto& input : inputs)
+            Random::fill(input, Range<double>(1.0));
+        state.items(matrices.size() * inputs.size());
+
+        state.run([&tensor, &inputs] { Bench::keep(tensor.evaluate(inputs)); });
+    });
+    shaped<16>(bench);
+    shaped<64>(bench);
+    shaped<256>(bench);
+
+    // sparse skip-layer graphs across densities, in process against a run of the generated code
+    const std::vector<std::tuple<std::string, std::vector<long long>>> sparse = { { "width", { 64, 256 } }, { "density", DENSITIES }, { "population", { 10 } } };
+    bench.grid("Evaluator::evaluate/sparse", sparse, [](Bench::State& state) {
+        Fixture fixture(state, true);
+        std::vector<Evaluator> evaluators;
+        for (const auto& network : fixture.networks)
+            evaluators.emplace_back(network.get_genome(), ActivatorSearch::function("sigmoid"));
+        std::vector<double> inputs(INPUTS);
+        Random::fill(inputs, Range<double>(1.0));
+
+        state.run([&evaluators, &inputs] {
+            for (const auto& evaluator : evaluators)
+                Bench::keep(evaluator.evaluate(inputs));
+        });
+    });
+    bench.grid("Compiler::execute/sparse", { { "width", { 64 } }, { "density", DENSITIES }, { "population", { 1 } } }, [](Bench::State& state) {
+        Fixture fixture(state, true);
+        Compiler compiler("bench");
+        const auto& network = fixture.networks.front();
+        network.prime();
+        benchmark::Probe::update(network);
+        compiler.compile("case", network.get_code());
+
+        std::string args = "";
+        for (int i = 0; i < INPUTS; i++)
+            args += args.empty() ? std::to_string(Random::generate(-1.0, 1.0)) : " "+std::to_string(Random::generate(-1.0, 1.0));
+
+        state.run([&compiler, &args] { Bench::keep(compiler.execute<double>("case", args)); });
+    });
+
+    // a g++ run per iteration, one network is plenty
+    const std::vector<std::tuple<std::string, std::vector<long long>>> single = { { "width", WIDTHS }, { "population", { 1 } } };
+    bench.grid("Compiler::compile", single, [](Bench::State& state) {
+        Fixture fixture(state);
+        Compiler compiler("bench");
+        const auto& network = fixture.networks.front();
+        network.prime();
+        benchmark::Probe::update(network);
+        const std::string code = network.get_code();
+
+        state.run([&compiler, &code] { compiler.compile("case", code); });
+    });
+    bench.grid("Compiler::execute", single, [](Bench::State& state) {
+        Fixture fixture(state);
+        Compiler compiler("bench");
+        const auto& network = fixture.networks.front();
+        network.prime();
+        benchmark::Probe::update(network);
+        compiler.compile("case", network.get_code());
+
+        std::string args = "";
+        for (int i = 0; i < INPUTS; i++)
+            args += args.empty() ? std::to_string(Random::generate(-1.0, 1.0)) : " "+std::to_string(Random::generate(-1.0, 1.0));
+
+        state.run([&compiler, &args] { Bench::keep(compiler.execute<double>("case", args)); });
+    });
+
+    // as many draws and ids as the population has neurons
+    bench.grid("Random::generate", grid, [](Bench::State& state) {
+        const long long count = state.get("width") * state.get("population");
+        const Range<double> range(1.0);
+        state.items(count);
+
+        state.run([count, &range] {
+            for (long long i = 0; i < count; i++)
+                Bench::keep(Random::generate(range));
+        });
+    });
+    bench.grid("Registry::add/erase", grid, [](Bench::State& state) {
+        const long long count = state.get("width") * state.get("population");
+        Registry<int> registry;
+        std::vector<int> ids(count);
+        state.items(count);
+
+        state.run([&registry, &ids] {
+            for (auto& id : ids)
+                id = registry.add(0x0);
+            for (const auto id : ids)
+                registry.erase(0x0, id);
+        });
+    });
+
+    bench.grid("Storage::save", grid, [](Bench::State& state) {
+        Fixture fixture(state);
+        state.run([&fixture] { Bench::keep(Storage::save("bench.bin", fixture.population)); });
+        std::remove("bench.bin");
+    });
+
+    bench.run();
+}
\ No newline at end of file
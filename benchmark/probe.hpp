@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include "../header/network.hpp"
+#include "../header/population.hpp"
+
+namespace benchmark {
+    // the one type the engine befriends for its benchmarks and checks, so they can reach internals
+    // that the public interface hides, without any other class named like it gaining that access
+    class Probe {
+        public:
+            static std::vector<Network>& networks(Population& population) { return population.networks; };
+            static const std::vector<Network>& networks(const Population& population) { return population.networks; };
+            static Network make(Population& population, const int index) { return population.new_network(index); };
+            static void update(const Network& network) { network.update(Network::InletOutlet); };
+            static void compile(Population& population) {
+                for (const auto& network : population.networks)
+                    network.compile();
+            };
+    };
+}
\ No newline at end of file
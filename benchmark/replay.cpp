@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "../module/trace/main.hpp"
+#include "../header/population.hpp"
+#include "../header/recorder.hpp"
+
+#include "probe.hpp"
+
+// re-runs one recorded generation standalone, to be profiled away from the training that produced it
+// usage: replay path [--backend interpreted|compiled] [--threads n] [--repeat n] [--trace path]
+// a recording comes from the training process:
+//     Recorder recorder(population);
+//     population.train(iterations);
+//     population.evolve();
+//     recorder.save(path);
+// sender inputs and trainer results come from the recording, so only the engine's own work is timed;
+// with a seeded configuration the children's mutations are checked against the recorded ones,
+// exits with 1 when any diverged
+// --trace writes a chrome trace of the replays when built with -DTRACING
+
+int main(int argc, char** argv) {
+    if (argc < 2)
+        throw std::invalid_argument("replay: missing recording path.");
+
+    const std::string path = argv[1];
+    std::string trace = "";
+    int repeat = 1;
+
+    auto recording = Recorder::load(path);
+    auto& config = recording.config;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i], value = argv[i + 1];
+        if (arg == "--backend") {
+            if (value == "interpreted")
+                config.network.backend = Configuration::Network::Interpreted;
+            else if (value == "compiled")
+                config.network.backend = Configuration::Network::Compiled;
+            else
+                throw std::invalid_argument("replay: unknown backend "+value+".");
+        } else if (arg == "--threads")
+            config.population.threads = std::stoi(value);
+        else if (arg == "--repeat")
+            repeat = std::stoi(value);
+        else if (arg == "--trace")
+            trace = value;
+        else
+            throw std::invalid_argument("replay: unknown option "+arg+".");
+    }
+    if (repeat <= 0 || config.population.threads < 0)
+        throw std::invalid_argument("replay: repeat must be positive and threads not negative.");
+
+    int iterations = 0;
+    for (const int calls : recording.tape.calls)
+        iterations += calls;
+    std::printf("%s: %zu networks, %d iterations, %s backend, %d threads, seed %s\n",
+        path.c_str(), recording.states.size(), iterations,
+        config.network.backend == Configuration::Network::Compiled ? "compiled" : "interpreted", config.population.threads,
+        config.population.seed.has_value() ? std::to_string(config.population.seed.value()).c_str() : "none");
+
+    using Clock = std::chrono::steady_clock;
+    auto since = [](const Clock::time_point from) { return std::chrono::duration<double>(Clock::now() - from).count(); };
+
+    int diverged = 0;
+    std::printf("%-6s %9s %9s %9s %9s %10s\n", "run", "load s", "compile s", "train s", "evolve s", "diverged");
+    for (int r = 0; r < repeat; r++) {
+        Population population(config);
+        double load = 0, compile = 0, train = 0, evolve = 0;
+
+        auto clock = Clock::now();
+        Recorder::install(population, recording);
+        load = since(clock);
+
+        if (config.network.backend == Configuration::Network::Compiled) {
+            clock = Clock::now();
+            benchmark::Probe::compile(population);
+            compile = since(clock);
+        }
+
+        clock = Clock::now();
+        for (const int calls : recording.tape.calls)
+            population.train(calls);
+        train = since(clock);
+
+        clock = Clock::now();
+        population.evolve();
+        evolve = since(clock);
+
+        const int children = config.population.seed.has_value() ? Recorder::verify(population, recording) : 0;
+        diverged += children;
+        std::printf("%-6d %9.3f %9.3f %9.3f %9.3f %10d\n", r, load, compile, train, evolve, children);
+        std::fflush(stdout);
+    }
+
+    if (!trace.empty())
+        Trace::dump(trace);
+    if (!config.population.seed.has_value())
+        std::printf("unseeded recording, mutations were not checked\n");
+    return diverged > 0 ? 1 : 0;
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <stdexcept>
 #include <vector>
@@ -17,15 +19,38 @@ struct Configuration {
         int size = 1e+2;
         int group = 1;
         double equality = 5e-2;
+        int threads = 0; // 0: hardware concurrency
+        std::optional<std::uint64_t> seed = std::nullopt; // deterministic across thread counts when set
+        struct Racing {
+            bool enabled = false;
+            int checkpoint = 10; // iterations between culls
+            double confidence = 1.96; // z-score of the bounds
+            double cutoff = 5e-1; // share of networks ranked above the cutoff
+        } racing;
+        struct Parallel {
+            enum Mode { Auto, Inter, Intra };
+            Mode mode = Auto;
+            int threshold = 1e+4; // network complexity from which Auto splits a network across workers
+            int grain = 256; // neurons per chunk of a level
+        } parallel;
     } population;
     struct Network {
+        enum Backend { Compiled, Interpreted };
+
         int inputs;
         int outputs;
         std::optional<std::vector<const int>> hidden = std::nullopt;
+        Backend backend = Compiled;
         struct Fitness {
             bool inverse = false;
             bool average = false;
+            bool deterministic = false; // unmodified clones inherit their parent's fitness
         } fitness;
+        struct Budget {
+            enum Action { Prune, Kill };
+            std::size_t bytes = 0; // per network, 0: unlimited
+            Action action = Prune; // pruning falls back to killing when it cannot get under the limit
+        } budget;
     } network;
     struct Neuron {
         Range<double> bias{1.0};
@@ -63,4 +88,22 @@ struct Configuration {
                 network.hidden = value;
             }
         };
+
+    std::uint64_t fingerprint() const { // FNV-1a over everything that shapes a genome
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+        auto mix = [&hash](const auto value) {
+            const auto bytes = reinterpret_cast<const unsigned char*>(&value);
+            for (std::size_t i = 0; i < sizeof(value); i++)
+                hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+        };
+
+        mix(network.inputs), mix(network.outputs);
+        mix(network.hidden.has_value());
+        if (network.hidden.has_value())
+            for (const int h : network.hidden.value())
+                mix(h);
+        mix(neuron.bias.min()), mix(neuron.bias.max());
+        mix(synapse.weight.min()), mix(synapse.weight.max());
+        return hash;
+    };
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "../typedef/functions.hpp"
+
+#include "../module/schedule/main.hpp"
+
+#include "genome.hpp"
+
+class Dense { // fixed topology: per layer, a row-major weight matrix over every earlier layer and a bias vector
+    private:
+        static constexpr int BLOCK = 4; // rows sharing one pass over the activations
+
+        ActivationFunction activator;
+
+        std::vector<int> sizes, offsets; // neurons per layer, and the index of its first neuron among all layers
+        std::vector<std::vector<double>> weights; // sizes[d] rows of offsets[d] columns, 0 where there is no synapse
+        std::vector<std::vector<double>> biases;
+        std::vector<std::vector<int>> links; // synapses per layer and earlier layer, empty blocks are skipped
+
+        void run(const int depth, const int begin, const int end, std::vector<double>& values) const;
+
+        friend class Tensor;
+
+    public:
+        Dense(const Genome& genome, const ActivationFunction& fn);
+
+        int get_size() const;
+        std::size_t get_memory() const; // bytes
+
+        // positions as in Network::Mutation; sources at or after <depth> are never read, as in the Evaluator
+        void set_bias(const int depth, const int height, const double bias);
+        void set_weight(const int depth, const int height, const int sourceDepth, const int sourceHeight, const double weight);
+
+        std::vector<double> evaluate(const std::vector<double>& inputs, const int threads = 1, const int grain = 256) const;
+};
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+#include "../typedef/functions.hpp"
+
+#include "../module/schedule/main.hpp"
+
+#include "genome.hpp"
+
+struct NetworkScope;
+
+// any topology as a sparse matrix: one row per neuron, stored level by level so every row
+// reads rows of earlier levels only, and its incoming weights in CSR next to the rows they read;
+// with AVX2 and FMA enabled long rows are gathered four sources at a time, which reorders their sums
+class Evaluator {
+    private:
+        static constexpr int GATHER = 8; // sources from which a row is worth gathering
+
+        ActivationFunction activator;
+
+        std::vector<int> entries; // per row, its height in the input layer, -1 otherwise
+        std::vector<double> biases;
+        std::vector<int> offsets; // the sources of row r are [offsets[r], offsets[r + 1])
+        std::vector<int> columns; // source rows
+        std::vector<double> weights;
+        std::vector<int> levels; // first row of every level, then the row count
+        std::vector<int> outputs;
+
+        void run(const int begin, const int end, const std::vector<double>& inputs, std::vector<double>& values) const;
+
+    public:
+        Evaluator(const Genome& genome, const ActivationFunction& fn);
+
+        int get_size() const;
+        int get_depth() const;
+        int get_width() const;
+        int get_synapses() const;
+        std::size_t get_memory() const; // bytes
+
+        std::vector<double> evaluate(const std::vector<double>& inputs, const int threads = 1, const int grain = 256) const;
+};
\ No newline at end of file
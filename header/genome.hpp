@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// copy-on-write network structure: copies share immutable neuron blocks, and a block
+// (or the layer listing it) is copied only when the copy holding it changes it
+class Genome {
+    public:
+        struct Synapse {
+            int source; // neuron id, so synapses survive neurons moving
+            double weight;
+        };
+        struct Neuron {
+            int id;
+            double bias;
+            std::vector<Synapse> synapses; // incoming
+        };
+        struct Memory {
+            std::size_t total = 0; // bytes reachable from this genome
+            double owned = 0; // the same, with shared blocks split between their holders
+        };
+
+    private:
+        using Layer = std::vector<std::shared_ptr<Neuron>>;
+
+        std::vector<std::shared_ptr<Layer>> layers;
+        int next = 0; // id of the next neuron
+
+        static std::atomic<std::uint64_t> allocated;
+        static void count(const Layer& layer);
+        static void count(const Neuron& neuron);
+
+        Layer& edit(const int depth);
+        Neuron& edit(const int depth, const int height);
+
+        void check(const int depth, const int height) const;
+        void unlink(const std::unordered_set<int>& ids);
+
+    public:
+        static std::uint64_t get_allocated(); // bytes allocated for blocks by every genome so far
+
+        int get_size() const;
+        int get_size(const int depth) const;
+        int get_neurons() const;
+        int get_synapses() const;
+
+        const Neuron& get_neuron(const int depth, const int height) const;
+        std::unordered_map<int, std::tuple<int, int>> get_positions() const; // id -> depth, height
+        Memory get_memory() const;
+
+        void clear();
+        void compact(); // gives back spare capacity of the blocks this genome owns alone
+
+        void add_layer(const int depth);
+        void remove_layer(const int depth);
+
+        int add_neuron(const int depth, const int height, const double bias);
+        void remove_neuron(const int depth, const int height);
+        void set_bias(const int depth, const int height, const double bias);
+
+        void add_synapse(const int depth, const int height, const int source, const double weight);
+        void remove_synapse(const int depth, const int height, const int index);
+        void set_weight(const int depth, const int height, const int index, const double weight);
+};
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../module/metrics/main.hpp"
+
+struct Meters { // the engine's instruments, resolved once per population
+    Metrics::Histogram &compile, &evaluation, &sender, &trainer, &receiver; // nanoseconds, exported in seconds
+    Metrics::Counter &compiles, &hits, &evaluations, &killed, &pruned;
+    std::vector<Metrics::Counter*> mutations; // by Network::Mutation::Kind
+    Metrics::Counter& allocated; // follows Genome::get_allocated(), which only grows
+    std::vector<std::tuple<double, Metrics::Gauge*>> complexity; // quantile, network complexity at it
+    std::vector<std::tuple<double, Metrics::Gauge*>> memory; // quantile, network bytes at it
+
+    Meters(Metrics& metrics);
+};
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <iterator>
 #include <list>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -13,8 +17,13 @@
 #include "../module/random/main.hpp"
 #include "../module/range/main.hpp"
 #include "../module/registry/main.hpp"
+#include "../module/trace/main.hpp"
 
 #include "configuration.hpp"
+#include "dense.hpp"
+#include "evaluator.hpp"
+#include "genome.hpp"
+#include "meters.hpp"
 #include "population.hpp"
 #include "layer.hpp"
 #include "neuron.hpp"
@@ -22,6 +31,7 @@
 
 struct NetworkScope {
     const Configuration& config;
+    Meters& meters;
     Registry<int> registry;
 
     std::list<Layer*> layers;
@@ -32,12 +42,22 @@ struct NetworkScope {
         std::unordered_map<const Neuron*, std::unordered_map<const Neuron*, Synapse*>> target;
     } synapses;
 
-    NetworkScope(const Configuration& config) : config(config), registry(), layers(), neurons(), synapses() {};
+    NetworkScope(const Configuration& config, Meters& meters) : config(config), meters(meters), registry(), layers(), neurons(), synapses() {};
 };
 
+namespace benchmark { class Probe; }
+
 class Network {
     public:
         enum Status { Dead, Alive };
+        struct Mutation { // journal entry, positions are list order at the time of the change
+            enum Kind { AddLayer, RemoveLayer, AddNeuron, RemoveNeuron, Bias, AddSynapse, RemoveSynapse, Weight };
+            Kind kind;
+            int depth, height = 0;
+            int sourceDepth = 0, sourceHeight = 0;
+            double value = 0; // resulting bias or weight
+            double previous = 0; // bias or weight before a change, compact checkpoints code <value> against it
+        };
         NetworkScope& scope;
 
     private:
@@ -56,24 +76,58 @@ class Network {
         int id, index;
 
         Status status;
+        bool modified = true;
+        double elapsed = 0; // measured seconds per evaluation, inherited by clones
+
+        Genome genome; // canonical structure, shared with clones until mutated
+        mutable bool stale = false; // the pointer graph in <scope> lags <genome> until prime()
+        std::shared_ptr<const Evaluator> evaluator; // immutable once built, so clones share it until they mutate
+        std::optional<Dense> dense; // interpreted fixed topologies, patched in place by evolve
+
+        int parent = -1; // index the network was cloned from, -1 when its journal has no base
+        bool detached = false;
+        std::vector<Mutation> journal;
 
         struct Fitness {
             double sum;
             int count;
+            double mean = 0, m2 = 0; // running Welford moments
         } fitness{ 0, 0 };
 
         enum Update { InletOutlet };
         void update(const Update type) const;
 
+        static std::map<int, int> tally(const int size, const double rate);
+
+        template <typename T>
+        static std::size_t footprint(const T& hashed) { // nodes and bucket array of an unordered container
+            return hashed.size() * (sizeof(typename T::value_type) + 2 * sizeof(void*)) + hashed.bucket_count() * sizeof(void*);
+        };
+
+        friend class benchmark::Probe;
+        friend class Recorder;
+
     public:
         struct ImportExport {
             int index;
             int fitCount; double fitSum;
-            ImportExport(const int i, const Fitness& fit) : index(i), fitCount(fit.count), fitSum(fit.sum) { };
+            Status status;
+            ImportExport(const int i, const Fitness& fit, const Status s = Alive) : index(i), fitCount(fit.count), fitSum(fit.sum), status(s) { };
         };
         struct Group : NetworkIndex {
             Group(int g, int i) : NetworkIndex(g, i) { };
         };
+        struct Bounds { double lower, upper; };
+        struct Memory { // bytes
+            std::size_t genome = 0; // every block reachable from the genome
+            double owned = 0; // genome bytes with shared blocks split between their holders
+            std::size_t scope = 0; // materialized graph: layer, neuron and synapse objects and the maps holding them
+            std::size_t sets = 0; // neuron inlet and outlet sets
+            std::size_t evaluator = 0;
+            std::size_t compiled = 0; // program and kept source on disk, outside the total
+
+            std::size_t total() const { return genome + scope + sets + evaluator; }; // resident, as budgets count it
+        };
 
         Network(
             const Population& pop, NetworkScope scp,
@@ -94,11 +148,28 @@ class Network {
         int get_index() const;
         const Group get_group() const;
         int get_size() const;
+        int get_complexity() const;
+        Memory memory() const;
+
+        double get_elapsed() const;
+        void set_elapsed(const double seconds);
 
         Status get_status() const;
         void set_status(const Status s);
 
         double get_fitness() const;
+        double get_variance() const;
+        const Bounds get_bounds(const double z) const;
+
+        bool is_modified() const;
+        bool is_cached() const;
+
+        int get_parent() const;
+        const std::vector<Mutation>& get_journal() const;
+        void detach();
+
+        const Genome& get_genome() const;
+        void set_genome(Genome g);
 
         Layer add_layer(const int d) const;
 
@@ -106,11 +177,14 @@ class Network {
         void init();
         void clone_from(const Network& other);
         void evolve();
+        bool prune(const std::size_t bytes);
 
         void prime() const;
         std::string get_code() const;
         std::string compile(const bool dbg = false) const;
-        void input(const std::vector<double>& inputs);
+        const Dense& get_dense(); // needs a fixed topology
+        double input(const std::vector<double>& inputs, const int threads = 1); // the fitness the trainer gave
+        double score(const std::vector<double>& output); // trainer and receiver on an output evaluated elsewhere
 
         void _import(const ImportExport data);
         const ImportExport _export() const;
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <future>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <string>
@@ -16,20 +19,28 @@
 #include "../module/math/main.hpp"
 #include "../module/random/main.hpp"
 #include "../module/registry/main.hpp"
+#include "../module/schedule/main.hpp"
+#include "../module/trace/main.hpp"
 
 #include "activator.hpp"
 #include "configuration.hpp"
+#include "meters.hpp"
 #include "network.hpp"
+#include "tape.hpp"
+#include "tensor.hpp"
 #include "layer.hpp"
 #include "neuron.hpp"
 #include "synapse.hpp"
 
+namespace benchmark { class Probe; }
+
 class Population {
     private:
         enum Status { OFF, PAUSED, TRAINING, ON };
         struct NetworkStat {
             double fitness = 0;
             std::string code = "";
+            long long evaluation = -1; // steady-state evaluation it came from, until its code is filled in
 
             bool operator==(const NetworkStat& other) const { return fitness == other.fitness; };
             bool operator!=(const NetworkStat& other) const { return fitness != other.fitness; };
@@ -46,6 +57,9 @@ class Population {
 
             public:
                 int generation = 0, alive = 0, dead = 0;
+                int steps = 0; // train iterations so far this generation, over every train call
+                long long evaluations = 0, saved = 0;
+                Schedule::Report schedule;
                 Extrema best, worst;
         };
 
@@ -58,12 +72,18 @@ class Population {
         Registry<int> networker;
         Compiler compiler;
 
+        Metrics monitor;
+        Meters meters;
+
         std::vector<Network> networks;
+        Tape* tape = nullptr; // set while a Recorder is attached
 
         struct Activator {
             ActivationFunction function;
             std::string string;
-        } _activator{ ActivatorSearch::function("sigmoid"), ActivatorSearch::string("sigmod") };
+            std::string name; // as requested, so recordings can look it up again
+            std::vector<double> consts;
+        } _activator{ ActivatorSearch::function("sigmoid"), ActivatorSearch::string("sigmod"), "sigmoid", { } };
         FitnessFunction _trainer{ [](NetworkIndex, std::vector<double>) -> double { return 0.0; } };
         InputFunction _sender{ [](NetworkIndex) -> std::vector<double> { return { }; } };
         OutputFunction _receiver{ [](NetworkIndex, std::vector<double>) { } };
@@ -71,18 +91,49 @@ class Population {
         Network new_network(const int index);
         Network add_network(const int index);
 
+        int workers() const;
+        void reseed(const int index, const int phase = 0) const;
+        double weight(double fit, const double min, const double max) const;
+        void evaluate(Network& network, const int iterations, const int threads = 1);
+        bool record(const Network& network);
+        void annotate(const long long evaluation, const std::string& code);
+        int race(const int remaining);
+        std::vector<double> costs(const std::vector<Network*>& batch) const;
+        void step();
+        void measure();
+        bool within(Network& network);
+        void enforce();
+
+        friend class Storage;
+        friend class Recorder;
+        friend class benchmark::Probe; // benchmarks reach networks directly
+
     public:
+        struct Memory {
+            double total = 0; // bytes, shared genome blocks split between their holders
+            double p50 = 0, p90 = 0, p99 = 0, max = 0; // bytes per network, shared blocks counted whole
+        };
+
         Population(const Configuration cfg) :
             config(cfg),
             networker(),
-            compiler("network") { };
+            compiler("network"),
+            monitor(), meters(monitor) { };
 
         Status status() const;
         int generation() const;
+        const Configuration& configuration() const;
 
         int size() const;
         int alive() const;
         int dead() const;
+        long long evaluations() const;
+        long long saved() const;
+        Schedule::Report makespan() const;
+
+        Memory memory() const;
+        Metrics::Snapshot metrics() const;
+        void metrics(const std::string path) const; // prometheus text, for a textfile scraper
 
         NetworkStat best(std::string type) const;
         NetworkStat worst(std::string type) const;
@@ -104,5 +155,10 @@ class Population {
         int kill(Args... args);
 
         void train(int iterations = 1, std::optional<int> interval = std::nullopt);
+        // fixed topologies: every live network on every input in one batched pass, bypassing the sender;
+        // the trainer sees each network's outputs in input order, and the fitness of every network is returned;
+        // a Recorder cannot replay it, so it throws while one is attached
+        std::vector<double> batch(const std::vector<std::vector<double>>& inputs);
         void evolve();
+        void steady(const int evaluations, const int iterations = 1);
 };
\ No newline at end of file
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../module/codec/main.hpp"
+
+#include "configuration.hpp"
+#include "population.hpp"
+#include "network.hpp"
+#include "storage.hpp"
+#include "tape.hpp"
+
+class Recorder { // captures one generation, its train calls then evolve, so it can be replayed without the user callbacks
+    public:
+        // recording layout, little-endian:
+        //   header  u32 magic, u16 version
+        //   config  every Configuration field in declaration order, ints as svarint, doubles as f64, flags as u8,
+        //           ranges as f64 min, f64 max, f64 step, u8 left, u8 right; then the activator name and constants
+        //   states  varint networks, per network u8 alive, u8 modified, f64 elapsed, f64 m2
+        //   tape    varint calls, varint iterations per call, then per network varint evaluations,
+        //           each varint inputs, f64 per input, f64 fitness
+        //   journal varint children, per child svarint parent, varint mutations,
+        //           each varint kind, svarint depth, height, source depth, source height, f64 value, f64 previous
+        // followed by a Storage checkpoint of the generation as it started, up to the end of the file
+        static constexpr std::uint32_t MAGIC = 0x50455258; // "XREP"
+        static constexpr std::uint16_t VERSION = 1;
+
+        struct State { // what a checkpoint leaves out of a network
+            bool alive, modified;
+            double elapsed, m2;
+        };
+        struct Child {
+            int parent;
+            std::vector<Network::Mutation> journal;
+        };
+        struct Recording {
+            Configuration config;
+            std::string activator;
+            std::vector<double> consts;
+            std::vector<State> states;
+            Tape tape;
+            std::vector<Child> children;
+            std::vector<char> checkpoint;
+        };
+
+    private:
+        Population& population;
+        const int generation;
+        std::vector<State> states;
+        std::vector<Storage::Genome> genomes;
+        Tape tape;
+
+        static inline const Recording* playing = nullptr;
+        static inline std::vector<std::size_t> cursors; // next evaluation per network
+
+        template <typename T>
+        static void fixed(std::vector<char>& out, const T value) {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        };
+        static void flag(std::vector<char>& out, const bool value) { out.push_back(value ? 1 : 0); };
+        static void range(std::vector<char>& out, const Range<double>& value) {
+            fixed(out, value.raw_min()), fixed(out, value.raw_max()), fixed(out, value.step());
+            flag(out, value.include_left()), flag(out, value.include_right());
+        };
+        static void rate(std::vector<char>& out, const Configuration::Mutation& value) { fixed(out, value.rate); };
+        static void rate(std::vector<char>& out, const Configuration::ChangeMutation& value) { fixed(out, value.rate), fixed(out, value.amount); };
+
+        static bool flag(Storage::Reader& reader) { return reader.fixed<std::uint8_t>() != 0; };
+        static Range<double> range(Storage::Reader& reader) {
+            const double min = reader.fixed<double>(), max = reader.fixed<double>(), step = reader.fixed<double>();
+            const bool left = flag(reader), right = flag(reader);
+            return Range<double>(min, max, step, left, right);
+        };
+        static std::size_t count(Storage::Reader& reader, const std::size_t unit) { // a varint length that the bytes left can hold
+            const std::size_t n = reader.varint();
+            if (n > reader.left() / unit)
+                throw std::runtime_error("Recorder::load: invalid count.");
+            return n;
+        };
+
+        static void configuration(std::vector<char>& out, const Configuration& config) {
+            const auto& population = config.population;
+            Codec::svarint(out, population.size), Codec::svarint(out, population.group);
+            fixed(out, population.equality);
+            Codec::svarint(out, population.threads);
+            flag(out, population.seed.has_value());
+            if (population.seed.has_value())
+                fixed(out, population.seed.value());
+            flag(out, population.racing.enabled);
+            Codec::svarint(out, population.racing.checkpoint);
+            fixed(out, population.racing.confidence), fixed(out, population.racing.cutoff);
+            Codec::varint(out, population.parallel.mode);
+            Codec::svarint(out, population.parallel.threshold), Codec::svarint(out, population.parallel.grain);
+
+            const auto& network = config.network;
+            Codec::svarint(out, network.inputs), Codec::svarint(out, network.outputs);
+            flag(out, network.hidden.has_value());
+            if (network.hidden.has_value()) {
+                Codec::varint(out, network.hidden.value().size());
+                for (const int h : network.hidden.value())
+                    Codec::svarint(out, h);
+            }
+            Codec::varint(out, network.backend);
+            flag(out, network.fitness.inverse), flag(out, network.fitness.average), flag(out, network.fitness.deterministic);
+            Codec::varint(out, network.budget.bytes), Codec::varint(out, network.budget.action);
+
+            range(out, config.neuron.bias);
+            range(out, config.synapse.weight);
+
+            const auto& mutate = config.mutate;
+            rate(out, mutate.layer.add), rate(out, mutate.layer.remove);
+            rate(out, mutate.neuron.add), rate(out, mutate.neuron.remove), rate(out, mutate.neuron.change);
+            rate(out, mutate.synapse.add), rate(out, mutate.synapse.remove), rate(out, mutate.synapse.change);
+        };
+        static Configuration configuration(Storage::Reader& reader) {
+            // the network shape comes first in the constructor, so the population block is read ahead of it
+            Configuration::Population population;
+            population.size = reader.svarint(), population.group = reader.svarint();
+            population.equality = reader.fixed<double>();
+            population.threads = reader.svarint();
+            if (flag(reader))
+                population.seed = reader.fixed<std::uint64_t>();
+            population.racing.enabled = flag(reader);
+            population.racing.checkpoint = reader.svarint();
+            population.racing.confidence = reader.fixed<double>(), population.racing.cutoff = reader.fixed<double>();
+            population.parallel.mode = static_cast<Configuration::Population::Parallel::Mode>(reader.varint());
+            population.parallel.threshold = reader.svarint(), population.parallel.grain = reader.svarint();
+
+            const int inputs = reader.svarint(), outputs = reader.svarint();
+            std::optional<std::vector<const int>> hidden = std::nullopt;
+            if (flag(reader)) {
+                std::vector<int> sizes(count(reader, 1));
+                for (auto& h : sizes)
+                    h = reader.svarint();
+                hidden = std::vector<const int>(sizes.begin(), sizes.end());
+            }
+
+            Configuration config(inputs, outputs, hidden);
+            config.population = population;
+
+            auto& network = config.network;
+            network.backend = static_cast<Configuration::Network::Backend>(reader.varint());
+            network.fitness.inverse = flag(reader), network.fitness.average = flag(reader), network.fitness.deterministic = flag(reader);
+            network.budget.bytes = reader.varint();
+            network.budget.action = static_cast<Configuration::Network::Budget::Action>(reader.varint());
+
+            config.neuron.bias = range(reader);
+            config.synapse.weight = range(reader);
+
+            auto& mutate = config.mutate;
+            for (auto* m : { &mutate.layer.add, &mutate.layer.remove, &mutate.neuron.add, &mutate.neuron.remove })
+                m->rate = reader.fixed<double>();
+            mutate.neuron.change.rate = reader.fixed<double>(), mutate.neuron.change.amount = reader.fixed<double>();
+            mutate.synapse.add.rate = reader.fixed<double>(), mutate.synapse.remove.rate = reader.fixed<double>();
+            mutate.synapse.change.rate = reader.fixed<double>(), mutate.synapse.change.amount = reader.fixed<double>();
+            return config;
+        };
+
+        static int flat(const NetworkIndex n) { return n.group * playing->config.population.group + n.index; };
+        static const Tape::Evaluation& next(const NetworkIndex n) {
+            const int index = flat(n);
+            const auto& evaluations = playing->tape.networks.at(index);
+            if (cursors[index] >= evaluations.size())
+                throw std::runtime_error("Recorder::replay: network "+std::to_string(index)+" evaluated more often than recorded.");
+            return evaluations[cursors[index]];
+        };
+        static std::vector<double> send(const NetworkIndex n) { return next(n).inputs; };
+        static double score(const NetworkIndex n, std::vector<double>) {
+            const double fitness = next(n).fitness;
+            cursors[flat(n)]++;
+            return fitness;
+        };
+
+    public:
+        Recorder(Population& pop) : population(pop), generation(pop.generation()), tape(pop.size()) {
+            if (population._status != Population::ON)
+                throw std::runtime_error("Recorder: population not started.");
+            if (population.tape != nullptr)
+                throw std::runtime_error("Recorder: population already recorded.");
+            if (population.statistics.steps != 0) // train streams are seeded by step, a replay starts from the first
+                throw std::runtime_error("Recorder: attach before the generation's first train call.");
+
+            for (const auto& network : population.networks) {
+                states.push_back({ network.get_status() == Network::Alive, network.modified, network.elapsed, network.fitness.m2 });
+                genomes.push_back(Storage::capture(network));
+            }
+            population.tape = &tape;
+        };
+        Recorder(const Recorder&) = delete;
+        Recorder(Recorder&&) = delete;
+
+        ~Recorder() { stop(); };
+
+        void stop() {
+            if (population.tape == &tape)
+                population.tape = nullptr;
+        };
+
+        std::size_t save(const std::string path) { // once evolve has run, the children's journals close the recording
+            stop();
+            if (tape.calls.empty() || population.generation() != generation + 1)
+                throw std::runtime_error("Recorder::save: expected train calls followed by one evolve.");
+
+            std::vector<char> out;
+            fixed(out, MAGIC), fixed(out, VERSION);
+
+            configuration(out, population.config);
+            Codec::varint(out, population._activator.name.size());
+            out.insert(out.end(), population._activator.name.begin(), population._activator.name.end());
+            Codec::varint(out, population._activator.consts.size());
+            for (const double c : population._activator.consts)
+                fixed(out, c);
+
+            Codec::varint(out, states.size());
+            for (const auto& state : states) {
+                flag(out, state.alive), flag(out, state.modified);
+                fixed(out, state.elapsed), fixed(out, state.m2);
+            }
+
+            Codec::varint(out, tape.calls.size());
+            for (const int iterations : tape.calls)
+                Codec::varint(out, iterations);
+            for (const auto& evaluations : tape.networks) {
+                Codec::varint(out, evaluations.size());
+                for (const auto& evaluation : evaluations) {
+                    Codec::varint(out, evaluation.inputs.size());
+                    for (const double input : evaluation.inputs)
+                        fixed(out, input);
+                    fixed(out, evaluation.fitness);
+                }
+            }
+
+            Codec::varint(out, population.networks.size());
+            for (const auto& child : population.networks) {
+                Codec::svarint(out, child.get_parent());
+                Codec::varint(out, child.get_journal().size());
+                for (const auto& m : child.get_journal()) {
+                    Codec::varint(out, m.kind);
+                    Codec::svarint(out, m.depth), Codec::svarint(out, m.height);
+                    Codec::svarint(out, m.sourceDepth), Codec::svarint(out, m.sourceHeight);
+                    fixed(out, m.value), fixed(out, m.previous);
+                }
+            }
+
+            Storage::Writer writer(path);
+            writer.put(out.data(), out.size());
+
+            std::vector<char> scratch;
+            Storage::header(writer, population.config.fingerprint(), generation, genomes.size());
+            for (const auto& genome : genomes)
+                Storage::record(writer, genome, scratch);
+
+            writer.close();
+            return writer.size();
+        };
+
+        static Recording load(const std::string path) {
+            const Storage::Mapping mapping(path);
+            Storage::Reader reader(mapping.data(), mapping.size());
+
+            if (reader.fixed<std::uint32_t>() != MAGIC)
+                throw std::runtime_error("Recorder::load: not a recording.");
+            if (reader.fixed<std::uint16_t>() != VERSION)
+                throw std::runtime_error("Recorder::load: unsupported recording version.");
+
+            Recording recording{ configuration(reader), "", { }, { }, Tape(), { }, { } };
+            const std::size_t length = count(reader, 1);
+            recording.activator.assign(reader.skip(length), length);
+            recording.consts.resize(count(reader, sizeof(double)));
+            for (auto& c : recording.consts)
+                c = reader.fixed<double>();
+
+            recording.states.resize(count(reader, 2 + 2 * sizeof(double)));
+            for (auto& state : recording.states) {
+                state.alive = flag(reader), state.modified = flag(reader);
+                state.elapsed = reader.fixed<double>(), state.m2 = reader.fixed<double>();
+            }
+
+            auto& tape = recording.tape;
+            tape.calls.resize(count(reader, 1));
+            for (auto& iterations : tape.calls)
+                iterations = reader.varint();
+            tape.networks.resize(recording.states.size());
+            for (auto& evaluations : tape.networks) {
+                evaluations.resize(count(reader, 1 + sizeof(double)));
+                for (auto& evaluation : evaluations) {
+                    evaluation.inputs.resize(count(reader, sizeof(double)));
+                    for (auto& input : evaluation.inputs)
+                        input = reader.fixed<double>();
+                    evaluation.fitness = reader.fixed<double>();
+                }
+            }
+
+            recording.children.resize(count(reader, 2));
+            for (auto& child : recording.children) {
+                child.parent = reader.svarint();
+                child.journal.resize(count(reader, 5 + 2 * sizeof(double)));
+                for (auto& m : child.journal) {
+                    const auto kind = reader.varint();
+                    if (kind > Network::Mutation::Weight)
+                        throw std::runtime_error("Recorder::load: invalid mutation kind.");
+                    m.kind = static_cast<Network::Mutation::Kind>(kind);
+                    m.depth = reader.svarint(), m.height = reader.svarint();
+                    m.sourceDepth = reader.svarint(), m.sourceHeight = reader.svarint();
+                    m.value = reader.fixed<double>(), m.previous = reader.fixed<double>();
+                }
+            }
+
+            const std::size_t rest = reader.left();
+            const char* checkpoint = reader.skip(rest);
+            recording.checkpoint.assign(checkpoint, checkpoint + rest);
+            return recording;
+        };
+
+        static void install(Population& population, const Recording& recording) {
+            // the replay callbacks go in first, networks take them over when the checkpoint creates them
+            playing = &recording;
+            cursors.assign(recording.tape.networks.size(), 0);
+
+            population.activator(recording.activator, recording.consts);
+            population.sender(send);
+            population.trainer(score);
+            population.receiver([](NetworkIndex, std::vector<double>) { });
+
+            Storage::load(recording.checkpoint.data(), recording.checkpoint.size(), population);
+            if (population.networks.size() != recording.states.size())
+                throw std::runtime_error("Recorder::install: checkpoint does not match the recorded states.");
+
+            int dead = 0;
+            for (std::size_t i = 0; i < recording.states.size(); i++) {
+                auto& network = population.networks[i];
+                const auto& state = recording.states[i];
+                network.modified = state.modified;
+                network.elapsed = state.elapsed;
+                network.fitness.m2 = state.m2;
+                if (!state.alive && network.get_status() == Network::Alive) {
+                    network.set_status(Network::Dead);
+                    dead++;
+                }
+            }
+            population.statistics.alive -= dead;
+            population.statistics.dead += dead;
+        };
+        static void replay(Population& population, const Recording& recording) {
+            for (const int iterations : recording.tape.calls)
+                population.train(iterations);
+            population.evolve();
+        };
+        static int verify(const Population& population, const Recording& recording) { // children whose parent or journal differ from the recording
+            if (population.networks.size() != recording.children.size())
+                return recording.children.size();
+
+            int diverged = 0;
+            for (std::size_t i = 0; i < recording.children.size(); i++) {
+                const auto& child = population.networks[i];
+                const auto& expected = recording.children[i];
+                const auto& journal = child.get_journal();
+
+                bool same = child.get_parent() == expected.parent && journal.size() == expected.journal.size();
+                for (std::size_t j = 0; same && j < journal.size(); j++) {
+                    const auto& a = journal[j];
+                    const auto& b = expected.journal[j];
+                    same = a.kind == b.kind && a.depth == b.depth && a.height == b.height
+                        && a.sourceDepth == b.sourceDepth && a.sourceHeight == b.sourceHeight
+                        && a.value == b.value && a.previous == b.previous;
+                }
+                diverged += !same;
+            }
+            return diverged;
+        };
+
+        Recorder& operator=(const Recorder&) = delete;
+        Recorder& operator=(Recorder&&) = delete;
+};
\ No newline at end of file
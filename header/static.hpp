@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "configuration.hpp"
+#include "genome.hpp"
+#include "network.hpp"
+#include "storage.hpp"
+
+struct StaticActivator { // stateless counterparts of ActivatorSearch's functions, others are any double(double) functor
+    struct Identity { double operator()(const double x) const { return x; }; };
+    struct RectifiedLinearUnit { double operator()(const double x) const { return std::max(0.0,x); }; };
+    struct Sigmoid { double operator()(const double x) const { return 1.0/(1.0+std::exp(-x)); }; };
+    struct SigmoidLinearUnit { double operator()(const double x) const { return x/(1.0+std::exp(-x)); }; };
+    struct HyperbolicTangent { double operator()(const double x) const { return std::tanh(x); }; };
+};
+
+// a trained network whose shape is known at build time: same layout and results as Dense,
+// but every size is a constant, so the loops unroll and evaluation never allocates;
+// the weights live inside the object, large shapes belong on the heap
+template <typename Activator, int Inputs, int Outputs, int... Hidden>
+class StaticNetwork {
+    static_assert(Inputs > 0 && Outputs > 0 && ((Hidden > 0) && ...), "StaticNetwork: sizes must be positive.");
+
+    public:
+        static constexpr int DEPTH = sizeof...(Hidden) + 2;
+        static constexpr std::array<int, DEPTH> SIZES = { Inputs, Hidden..., Outputs };
+
+    private:
+        static constexpr std::array<int, DEPTH + 1> OFFSETS = [] { // first neuron of each layer among all layers
+            std::array<int, DEPTH + 1> offsets{ };
+            for (int d = 0; d < DEPTH; d++)
+                offsets[d + 1] = offsets[d] + SIZES[d];
+            return offsets;
+        }();
+        static constexpr std::array<std::size_t, DEPTH + 1> STARTS = [] { // first weight of each layer's matrix
+            std::array<std::size_t, DEPTH + 1> starts{ };
+            for (int d = 0; d < DEPTH; d++)
+                starts[d + 1] = starts[d] + static_cast<std::size_t>(SIZES[d]) * OFFSETS[d];
+            return starts;
+        }();
+        static constexpr int SIZE = OFFSETS[DEPTH];
+
+        [[no_unique_address]] Activator activator;
+        std::array<double, STARTS[DEPTH]> weights{ }; // per layer [column][row], transposed as in Tensor
+        std::array<double, SIZE> biases{ };
+
+        void set_weight(const int depth, const int height, const int sourceDepth, const int sourceHeight, const double weight) {
+            if (sourceDepth < 0 || sourceDepth >= depth) // never read, as in the Evaluator
+                return;
+            if (sourceHeight < 0 || sourceHeight >= SIZES[sourceDepth])
+                throw std::out_of_range("StaticNetwork::set_weight: invalid source.");
+            weights[STARTS[depth] + static_cast<std::size_t>(OFFSETS[sourceDepth] + sourceHeight) * SIZES[depth] + height] = weight;
+        };
+        template <typename F>
+        void check(const int depths, F&& size) const {
+            if (depths != DEPTH)
+                throw std::invalid_argument("StaticNetwork: genome has "+std::to_string(depths)+" layers, not "+std::to_string(DEPTH)+".");
+            for (int d = 0; d < DEPTH; d++)
+                if (size(d) != SIZES[d])
+                    throw std::invalid_argument("StaticNetwork: layer "+std::to_string(d)+" differs in size.");
+        };
+
+        template <int D>
+        void run(std::array<double, SIZE>& values) const { // columns outer, so the rows vectorize without reordering a sum
+            constexpr int rows = SIZES[D], columns = OFFSETS[D];
+            const double* matrix = weights.data() + STARTS[D];
+
+            std::array<double, rows> sums;
+            for (int row = 0; row < rows; row++)
+                sums[row] = biases[columns + row];
+            for (int column = 0; column < columns; column++) {
+                const double value = values[column];
+                const double* weight = matrix + static_cast<std::size_t>(column) * rows;
+                for (int row = 0; row < rows; row++)
+                    sums[row] += weight[row] * value;
+            }
+            for (int row = 0; row < rows; row++)
+                values[columns + row] = activator(sums[row]);
+        };
+
+    public:
+        explicit StaticNetwork(const Genome& genome, const Activator& fn = Activator()) : activator(fn) {
+            check(genome.get_size(), [&genome](const int d) { return genome.get_size(d); });
+
+            const auto positions = genome.get_positions();
+            for (int depth = 0; depth < DEPTH; depth++)
+                for (int height = 0; height < SIZES[depth]; height++) {
+                    const auto& neuron = genome.get_neuron(depth, height);
+                    biases[OFFSETS[depth] + height] = neuron.bias;
+                    for (const auto& synapse : neuron.synapses) {
+                        const auto found = positions.find(synapse.source);
+                        if (found != positions.end())
+                            set_weight(depth, height, std::get<0>(found->second), std::get<1>(found->second), synapse.weight);
+                    }
+                }
+        };
+        explicit StaticNetwork(const Network& network, const Activator& fn = Activator()) : StaticNetwork(network.get_genome(), fn) { };
+        explicit StaticNetwork(const Storage::Genome& genome, const Activator& fn = Activator()) : activator(fn) {
+            check(static_cast<int>(genome.layers.size()), [&genome](const int d) { return static_cast<int>(genome.layers[d].size()); });
+
+            for (int depth = 0; depth < DEPTH; depth++)
+                for (int height = 0; height < SIZES[depth]; height++) {
+                    const auto& neuron = genome.layers[depth][height];
+                    biases[OFFSETS[depth] + height] = neuron.bias;
+                    for (const auto& synapse : neuron.synapses)
+                        set_weight(depth, height, synapse.depth, synapse.height, synapse.weight);
+                }
+        };
+
+        // the network stored under <index> in a checkpoint written with <config>
+        static StaticNetwork load(const std::string path, const Configuration& config, const int index, const Activator& fn = Activator()) {
+            for (const auto& genome : Storage::read(path, config.fingerprint()))
+                if (genome.index == index)
+                    return StaticNetwork(genome, fn);
+            throw std::invalid_argument("StaticNetwork::load: no network "+std::to_string(index)+" in "+path+".");
+        };
+
+        static constexpr int get_size() { return SIZE; };
+
+        std::array<double, Outputs> evaluate(const std::array<double, Inputs>& inputs) const {
+            std::array<double, SIZE> values;
+            for (int h = 0; h < Inputs; h++)
+                values[h] = activator(biases[h] + inputs[h]);
+
+            [this, &values]<std::size_t... D>(std::index_sequence<D...>) {
+                (run<D + 1>(values), ...);
+            }(std::make_index_sequence<DEPTH - 1>());
+
+            std::array<double, Outputs> outputs;
+            for (int h = 0; h < Outputs; h++)
+                outputs[h] = values[OFFSETS[DEPTH - 1] + h];
+            return outputs;
+        };
+};
\ No newline at end of file
@@ -1,17 +1,38 @@
 #pragma once
 
-#include <array>
-#include <bitset>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <climits>
+#include <condition_variable>
+#include <cstdint>
 #include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
 #include <functional>
-#include <limits>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <sys/stat.h>
+#include <thread>
 #include <tuple>
+#include <unistd.h>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "../module/codec/main.hpp"
+#include "../module/schedule/main.hpp"
+
 #include "population.hpp"
 #include "network.hpp"
 #include "layer.hpp"
@@ -19,118 +40,1111 @@
 #include "synapse.hpp"
 
 class Storage {
+    public:
+        // checkpoint layout, little-endian:
+        //   header  u32 magic, u16 version, u16 flags, u64 configuration fingerprint, varint generation, varint networks
+        //   network u32 payload bytes, then varint index, f64 fitness sum, varint fitness count, u8 alive,
+        //           varint layers, varint neurons per layer, then every neuron in layer order
+        //   neuron  f64 bias, varint synapses
+        //   synapse varint source depth, varint source height, f64 weight
+        // with the DELTA flag every payload starts with varint kind: 0 is followed by a network as above,
+        // 1 by varint index, varint parent, f64 fitness sum, varint fitness count, u8 alive, varint mutations
+        //   mutation varint kind, varint depth, [varint height], [varint source depth, varint source height], [f64 value]
+        // with the COMPACT flag biases, weights and journal values are XOR coded (Codec::Floats) into one bit stream,
+        // stored as varint bytes and the stream right after the layer sizes or mutation count; journal changes are coded
+        // against the value they replace; synapses are sorted by source and store zig-zag steps from the previous source,
+        // starting at the neuron's own depth; FLOAT32 additionally rounds those values to single precision
+        static constexpr std::uint32_t MAGIC = 0x54454e58; // "XNET"
+        static constexpr std::uint16_t VERSION = 2; // 2 added the alive flag
+        static constexpr std::uint16_t DELTA = 0x1;
+        static constexpr std::uint16_t COMPACT = 0x2;
+        static constexpr std::uint16_t FLOAT32 = 0x4; // lossy, implies COMPACT
+
+        struct Genome { // plain copy of a network, free of the pointer graph
+            struct Synapse { int depth, height; double weight; }; // incoming, by source position
+            struct Neuron {
+                double bias;
+                std::vector<Synapse> synapses;
+            };
+
+            int index = 0;
+            double fitSum = 0; int fitCount = 0;
+            bool alive = true; // dead networks keep the partial fitness racing, kills or budgets left them with
+            std::vector<std::vector<Neuron>> layers;
+        };
+
+        class Writer { // buffered writes straight to a file descriptor
+            private:
+                int fd;
+                std::vector<char> buffer;
+                std::size_t used = 0, written = 0;
+
+            public:
+                Writer(const std::string path, const std::size_t capacity = 1 << 20) : buffer(capacity) {
+                    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_BINARY
+                    flags |= O_BINARY;
+#endif
+                    fd = ::open(path.c_str(), flags, 0644);
+                    if (fd < 0)
+                        throw std::runtime_error("Storage::Writer: could not open "+path);
+                };
+                Writer(const Writer&) = delete;
+                Writer(Writer&&) = delete;
+
+                ~Writer() {
+                    try {
+                        close();
+                    } catch (...) { };
+                };
+
+                void put(const void* data, std::size_t size) {
+                    const char* bytes = static_cast<const char*>(data);
+                    if (size >= buffer.size()) { // too large to be worth copying
+                        flush();
+                        raw(bytes, size);
+                        return;
+                    }
+
+                    if (used + size > buffer.size())
+                        flush();
+                    std::memcpy(buffer.data() + used, bytes, size);
+                    used += size;
+                };
+                template <typename T>
+                void put(const T value) { put(&value, sizeof(T)); };
+
+                void raw(const char* bytes, std::size_t size) {
+                    while (size > 0) {
+                        const auto n = ::write(fd, bytes, size);
+                        if (n < 0)
+                            throw std::runtime_error("Storage::Writer: write failed");
+                        bytes += n, size -= n, written += n;
+                    }
+                };
+                void flush() {
+                    raw(buffer.data(), used);
+                    used = 0;
+                };
+                void sync() {
+                    flush();
+#ifdef _WIN32
+                    ::_commit(fd);
+#else
+                    ::fsync(fd);
+#endif
+                };
+                void close() {
+                    if (fd < 0)
+                        return;
+                    flush();
+                    ::close(fd);
+                    fd = -1;
+                };
+
+                std::size_t size() const { return written + used; };
+
+                Writer& operator=(const Writer&) = delete;
+                Writer& operator=(Writer&&) = delete;
+        };
+
+        class Mapping { // read-only view of a whole file, memory-mapped where available
+            private:
+                const char* bytes = nullptr;
+                std::size_t length = 0;
+#ifdef _WIN32
+                std::vector<char> copy;
+#endif
+
+            public:
+                Mapping(const std::string path) {
+                    int flags = O_RDONLY;
+#ifdef O_BINARY
+                    flags |= O_BINARY;
+#endif
+                    const int fd = ::open(path.c_str(), flags);
+                    if (fd < 0)
+                        throw std::runtime_error("Storage::Mapping: could not open "+path);
+
+                    struct stat info;
+                    if (::fstat(fd, &info) != 0) {
+                        ::close(fd);
+                        throw std::runtime_error("Storage::Mapping: could not stat "+path);
+                    }
+                    length = info.st_size;
+
+#ifdef _WIN32
+                    copy.resize(length);
+                    for (std::size_t done = 0; done < length; ) {
+                        const auto n = ::read(fd, copy.data() + done, length - done);
+                        if (n <= 0) {
+                            ::close(fd);
+                            throw std::runtime_error("Storage::Mapping: read failed");
+                        }
+                        done += n;
+                    }
+                    bytes = copy.data();
+#else
+                    if (length > 0) {
+                        void* map = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (map == MAP_FAILED) {
+                            ::close(fd);
+                            throw std::runtime_error("Storage::Mapping: mmap failed");
+                        }
+                        bytes = static_cast<const char*>(map);
+                    }
+#endif
+                    ::close(fd);
+                };
+                Mapping(const Mapping&) = delete;
+                Mapping(Mapping&&) = delete;
+
+                ~Mapping() {
+#ifndef _WIN32
+                    if (bytes != nullptr)
+                        ::munmap(const_cast<char*>(bytes), length);
+#endif
+                };
+
+                const char* data() const { return bytes; };
+                std::size_t size() const { return length; };
+
+                Mapping& operator=(const Mapping&) = delete;
+                Mapping& operator=(Mapping&&) = delete;
+        };
+
+        class Reader { // bounds-checked cursor, records are validated as they are read
+            private:
+                const char* at;
+                const char* end;
+
+            public:
+                Reader(const char* data, const std::size_t size) : at(data), end(data + size) { };
+
+                std::size_t left() const { return end - at; };
+
+                const char* skip(const std::size_t size) {
+                    if (left() < size)
+                        throw std::runtime_error("Storage::Reader: truncated checkpoint");
+                    const char* start = at;
+                    at += size;
+                    return start;
+                };
+                template <typename T>
+                T fixed() {
+                    T value;
+                    std::memcpy(&value, skip(sizeof(T)), sizeof(T));
+                    return value;
+                };
+                std::uint64_t varint() { return Codec::varint(*this); };
+                std::int64_t svarint() { return Codec::svarint(*this); };
+        };
+
     private:
+        static void varint(std::vector<char>& out, const std::uint64_t n) { Codec::varint(out, n); };
+        static void svarint(std::vector<char>& out, const std::int64_t n) { Codec::svarint(out, n); };
+        static std::uint16_t normalize(const std::uint16_t flags) { return flags & FLOAT32 ? flags | COMPACT : flags; };
         template <typename T>
-        static constexpr int bitsizeof() { return sizeof(T)*CHAR_BIT; };
+        static void fixed(std::vector<char>& out, const T value) {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        };
+
+        static void encode(std::vector<char>& out, const Genome& genome, const std::uint16_t flags = 0) {
+            varint(out, genome.index);
+            fixed(out, genome.fitSum);
+            varint(out, genome.fitCount);
+            fixed<std::uint8_t>(out, genome.alive);
+
+            varint(out, genome.layers.size());
+            for (const auto& layer : genome.layers)
+                varint(out, layer.size());
+
+            if (!(flags & COMPACT)) {
+                for (const auto& layer : genome.layers)
+                    for (const auto& neuron : layer) {
+                        fixed(out, neuron.bias);
+                        varint(out, neuron.synapses.size());
+                        for (const auto& synapse : neuron.synapses) {
+                            varint(out, synapse.depth);
+                            varint(out, synapse.height);
+                            fixed(out, synapse.weight);
+                        }
+                    }
+                return;
+            }
+
+            // biases and weights get a coder each, so every value is XORed against the previous one of its kind;
+            // all values go first as one bit stream, the synapse layout follows as bytes
+            Codec::Bits values;
+            Codec::Floats biasCoder(flags & FLOAT32), weightCoder(flags & FLOAT32);
+            std::vector<char> layout;
+            std::vector<const Genome::Synapse*> sorted;
+            for (int depth = 0; depth < static_cast<int>(genome.layers.size()); depth++)
+                for (const auto& neuron : genome.layers[depth]) {
+                    biasCoder.put(values, neuron.bias);
+                    varint(layout, neuron.synapses.size());
+
+                    sorted.clear();
+                    for (const auto& synapse : neuron.synapses)
+                        sorted.push_back(&synapse);
+                    std::sort(sorted.begin(), sorted.end(), [](const Genome::Synapse* a, const Genome::Synapse* b) {
+                        return a->depth != b->depth ? a->depth < b->depth : a->height < b->height;
+                    });
 
-        enum ObjectType : short {
-            population,
-            best,
-            worst,
-            network,
-            layer,
-            neuron,
-            synapse
+                    int d = depth, h = 0;
+                    for (const auto synapse : sorted) {
+                        if (synapse->depth != d)
+                            h = 0;
+                        svarint(layout, synapse->depth - d);
+                        svarint(layout, synapse->height - h);
+                        d = synapse->depth, h = synapse->height;
+                        weightCoder.put(values, synapse->weight);
+                    }
+                }
+
+            varint(out, values.data().size());
+            out.insert(out.end(), values.data().begin(), values.data().end());
+            out.insert(out.end(), layout.begin(), layout.end());
         };
 
-        template <typename T>
-        static unsigned long long encode(const T n) {
-            std::bitset<bitsizeof<T>()> bits;
-            std::memcpy(&bits, &n, sizeof(T));
-            return bits.to_ullong();
+        template <typename V>
+        static void parse(Reader& reader, V& visitor, const std::uint16_t flags = 0) {
+            const int index = reader.varint();
+            const double fitSum = reader.fixed<double>();
+            const int fitCount = reader.varint();
+            const bool alive = reader.fixed<std::uint8_t>() != 0;
+
+            const std::size_t layers = reader.varint();
+            if (layers > reader.left())
+                throw std::runtime_error("Storage::parse: invalid layer count");
+
+            std::vector<int> sizes(layers);
+            for (auto& size : sizes) {
+                size = reader.varint();
+                if (static_cast<std::size_t>(size) > reader.left())
+                    throw std::runtime_error("Storage::parse: invalid neuron count");
+            }
+
+            const bool compact = flags & COMPACT;
+            Codec::Floats biasCoder(flags & FLOAT32), weightCoder(flags & FLOAT32);
+            Codec::BitReader values(nullptr, 0);
+            if (compact) {
+                const std::size_t bytes = reader.varint();
+                values = Codec::BitReader(reader.skip(bytes), bytes);
+            }
+
+            visitor.begin(index, fitSum, fitCount, alive, sizes);
+            for (int depth = 0; depth < static_cast<int>(layers); depth++)
+                for (int height = 0; height < sizes[depth]; height++) {
+                    visitor.neuron(depth, height, compact ? biasCoder.get(values) : reader.fixed<double>());
+
+                    const std::size_t count = reader.varint();
+                    std::int64_t d = depth, h = 0;
+                    for (std::size_t i = 0; i < count; i++) {
+                        if (compact) {
+                            const std::int64_t step = reader.svarint();
+                            h = (step == 0 ? h : 0) + reader.svarint();
+                            d += step;
+                        } else
+                            d = reader.varint(), h = reader.varint();
+                        const double weight = compact ? weightCoder.get(values) : reader.fixed<double>();
+
+                        if (d < 0 || d >= static_cast<std::int64_t>(layers) || h < 0 || h >= sizes[d] || (d == depth && h == height))
+                            throw std::runtime_error("Storage::parse: invalid synapse source");
+
+                        visitor.synapse(depth, height, d, h, weight);
+                    }
+                }
         };
-        template <typename T>
-        static T decode(const std::bitset<bitsizeof<T>()>& bits) {
-            T n;
-            std::memcpy(&n, &bits, sizeof(T));
-            return n;
-        };
-
-        static struct Save {
-            static struct Call {
-                static const std::vector<unsigned long long> synapse(const Synapse& synapse) {
-                    const auto data = synapse._export();
-                    return {
-                        encode(ObjectType::synapse),
-                        encode(data.index),
-                        encode(data.sourceDepth),
-                        encode(data.sourceHeight),
-                        encode(data.targetDepth),
-                        encode(data.targetHeight),
-                        encode(data.weight)
-                    };
+
+        struct Decoder {
+            Genome genome;
+
+            void begin(const int index, const double fitSum, const int fitCount, const bool alive, const std::vector<int>& sizes) {
+                genome.index = index;
+                genome.fitSum = fitSum, genome.fitCount = fitCount;
+                genome.alive = alive;
+                for (const int size : sizes)
+                    genome.layers.emplace_back(size);
+            };
+            void neuron(const int depth, const int height, const double bias) { genome.layers[depth][height].bias = bias; };
+            void synapse(const int depth, const int height, const int d, const int h, const double weight) {
+                genome.layers[depth][height].synapses.push_back({ d, h, weight });
+            };
+        };
+        struct Builder { // rebuilds a network's genome straight from a record
+            Network& network;
+            ::Genome genome;
+            std::vector<std::vector<int>> ids;
+
+            void begin(const int index, const double fitSum, const int fitCount, const bool alive, const std::vector<int>& sizes) {
+                network.clear();
+                for (int depth = 0; depth < static_cast<int>(sizes.size()); depth++) {
+                    genome.add_layer(depth);
+                    ids.emplace_back();
+                    for (int height = 0; height < sizes[depth]; height++)
+                        ids[depth].push_back(genome.add_neuron(depth, height, 0));
+                }
+
+                network._import(Network::ImportExport(index, { fitSum, fitCount }, alive ? Network::Alive : Network::Dead));
+            };
+            void neuron(const int depth, const int height, const double bias) { genome.set_bias(depth, height, bias); };
+            void synapse(const int depth, const int height, const int d, const int h, const double weight) {
+                genome.add_synapse(depth, height, ids.at(d).at(h), weight);
+            };
+            void end() { network.set_genome(std::move(genome)); };
+        };
+
+        struct Header {
+            std::uint16_t flags;
+            int generation;
+            std::size_t count;
+        };
+        static Header check(Reader& reader, const std::uint64_t fingerprint) {
+            if (reader.fixed<std::uint32_t>() != MAGIC)
+                throw std::runtime_error("Storage::load: not a checkpoint.");
+            if (reader.fixed<std::uint16_t>() != VERSION)
+                throw std::runtime_error("Storage::load: unsupported checkpoint version.");
+            const auto flags = reader.fixed<std::uint16_t>();
+            if (flags & ~(DELTA | COMPACT | FLOAT32))
+                throw std::runtime_error("Storage::load: unsupported checkpoint flags.");
+            if (reader.fixed<std::uint64_t>() != fingerprint)
+                throw std::runtime_error("Storage::load: checkpoint was written for another configuration.");
+
+            const int generation = reader.varint();
+            const std::size_t count = reader.varint();
+            if (count > reader.left() / sizeof(std::uint32_t))
+                throw std::runtime_error("Storage::load: invalid network count.");
+            return { flags, generation, count };
+        };
+        static std::vector<std::tuple<const char*, std::uint32_t>> table(Reader& reader, const std::size_t count) {
+            std::vector<std::tuple<const char*, std::uint32_t>> records;
+            records.reserve(count);
+            for (std::size_t i = 0; i < count; i++) {
+                const auto size = reader.fixed<std::uint32_t>();
+                records.push_back({ reader.skip(size), size });
+            }
+            return records;
+        };
+
+        static void install(Population& population, const int generation, const std::vector<double>& costs, const std::function<void(const int, Network&)> rebuild) {
+            if (population._status != Population::OFF)
+                throw std::runtime_error("Storage::load: population already started.");
+            const int count = costs.size();
+
+            population.networker.erase(0x0);
+            population.networks.clear();
+            for (int i = 0; i < count; i++)
+                population.add_network(i);
+
+            std::vector<std::exception_ptr> errors(count);
+            Schedule::run(costs, population.workers(), [&errors, &population, &rebuild](const int i) {
+                try {
+                    rebuild(i, population.networks[i]);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+            for (const auto& error : errors)
+                if (error)
+                    std::rethrow_exception(error);
+
+            int dead = 0;
+            for (const auto& network : population.networks)
+                dead += network.get_status() == Network::Dead;
+            population.statistics = { generation, count - dead, dead, { }, { } };
+            population._status = Population::ON;
+        };
+
+        static bool positioned(const Network::Mutation::Kind kind) { return kind != Network::Mutation::AddLayer && kind != Network::Mutation::RemoveLayer; };
+        static bool linked(const Network::Mutation::Kind kind) {
+            return kind == Network::Mutation::AddSynapse || kind == Network::Mutation::RemoveSynapse || kind == Network::Mutation::Weight;
+        };
+        static bool valued(const Network::Mutation::Kind kind) {
+            return kind == Network::Mutation::AddNeuron || kind == Network::Mutation::Bias || kind == Network::Mutation::AddSynapse || kind == Network::Mutation::Weight;
+        };
+
+        static void journal(std::vector<char>& out, const Network& network, const std::uint16_t flags = 0) {
+            const auto data = network._export();
+            const auto& mutations = network.get_journal();
+
+            varint(out, 1);
+            varint(out, data.index);
+            varint(out, network.get_parent());
+            fixed(out, data.fitSum);
+            varint(out, data.fitCount);
+            fixed<std::uint8_t>(out, data.status == Network::Alive);
+
+            varint(out, mutations.size());
+
+            // changed values are coded against the value they replace, new neurons and synapses against each other
+            const bool compact = flags & COMPACT;
+            Codec::Bits values;
+            Codec::Floats changes(flags & FLOAT32), fresh(flags & FLOAT32);
+            std::vector<char> layout;
+            for (const auto& mutation : mutations) {
+                varint(layout, mutation.kind);
+                varint(layout, mutation.depth);
+                if (positioned(mutation.kind))
+                    varint(layout, mutation.height);
+                if (linked(mutation.kind)) {
+                    varint(layout, mutation.sourceDepth);
+                    varint(layout, mutation.sourceHeight);
+                }
+                if (!valued(mutation.kind))
+                    continue;
+
+                if (!compact)
+                    fixed(layout, mutation.value);
+                else if (mutation.kind == Network::Mutation::Bias || mutation.kind == Network::Mutation::Weight) {
+                    changes.against(mutation.previous);
+                    changes.put(values, mutation.value);
+                } else
+                    fresh.put(values, mutation.value);
+            }
+
+            if (compact) {
+                varint(out, values.data().size());
+                out.insert(out.end(), values.data().begin(), values.data().end());
+            }
+            out.insert(out.end(), layout.begin(), layout.end());
+        };
+        static Genome delta(Reader& reader, const std::vector<Genome>& base, const std::uint16_t flags = 0) {
+            if (reader.varint() == 0) {
+                Decoder decoder;
+                parse(reader, decoder, flags);
+                return decoder.genome;
+            }
+
+            const int index = reader.varint();
+            const std::size_t parent = reader.varint();
+            if (parent >= base.size())
+                throw std::runtime_error("Storage::delta: parent outside the base checkpoint.");
+
+            Genome genome = base[parent];
+            genome.index = index;
+            genome.fitSum = reader.fixed<double>();
+            genome.fitCount = reader.varint();
+            genome.alive = reader.fixed<std::uint8_t>() != 0;
+
+            const std::size_t count = reader.varint();
+            if (count > reader.left())
+                throw std::runtime_error("Storage::delta: invalid mutation count.");
+
+            const bool compact = flags & COMPACT;
+            Codec::BitReader values(nullptr, 0);
+            if (compact) {
+                const std::size_t bytes = reader.varint();
+                values = Codec::BitReader(reader.skip(bytes), bytes);
+            }
+
+            // mutations are applied as they are read, changed values are decoded against the genome they change
+            Codec::Floats changes(flags & FLOAT32), fresh(flags & FLOAT32);
+            for (std::size_t i = 0; i < count; i++) {
+                Network::Mutation mutation;
+                const auto kind = reader.varint();
+                if (kind > Network::Mutation::Weight)
+                    throw std::runtime_error("Storage::delta: invalid mutation kind.");
+
+                mutation.kind = static_cast<Network::Mutation::Kind>(kind);
+                mutation.depth = reader.varint();
+                if (positioned(mutation.kind))
+                    mutation.height = reader.varint();
+                if (linked(mutation.kind)) {
+                    mutation.sourceDepth = reader.varint();
+                    mutation.sourceHeight = reader.varint();
+                }
+                if (valued(mutation.kind)) {
+                    if (!compact)
+                        mutation.value = reader.fixed<double>();
+                    else if (mutation.kind == Network::Mutation::Bias || mutation.kind == Network::Mutation::Weight) {
+                        changes.against(reference(genome, mutation));
+                        mutation.value = changes.get(values);
+                    } else
+                        mutation.value = fresh.get(values);
+                }
+
+                apply(genome, mutation);
+            }
+            return genome;
+        };
+
+        static std::size_t save_delta(const std::string path, const Population& population, std::uint16_t flags = 0) {
+            flags = normalize(flags) | DELTA;
+
+            Writer writer(path);
+            header(writer, population.configuration().fingerprint(), population.generation(), population.networks.size(), flags);
+
+            std::vector<char> scratch;
+            for (const auto& network : population.networks) {
+                scratch.clear();
+                if (network.get_parent() < 0) { // no base, stored whole
+                    varint(scratch, 0);
+                    encode(scratch, capture(network), flags);
+                } else
+                    journal(scratch, network, flags);
+
+                writer.put(static_cast<std::uint32_t>(scratch.size()));
+                writer.put(scratch.data(), scratch.size());
+            }
+
+            writer.close();
+            return writer.size();
+        };
+
+        static double reference(const Genome& genome, const Network::Mutation& m) { // bias or weight a mutation replaces
+            const auto& layers = genome.layers;
+            if (m.depth < 0 || m.depth >= static_cast<int>(layers.size()) || m.height < 0 || m.height >= static_cast<int>(layers[m.depth].size()))
+                throw std::runtime_error("Storage::apply: mutation outside the genome.");
+
+            const auto& neuron = layers[m.depth][m.height];
+            if (m.kind == Network::Mutation::Bias)
+                return neuron.bias;
+            for (const auto& synapse : neuron.synapses)
+                if (synapse.depth == m.sourceDepth && synapse.height == m.sourceHeight)
+                    return synapse.weight;
+            throw std::runtime_error("Storage::apply: no such synapse.");
+        };
+
+    public:
+        static void apply(Genome& genome, const std::vector<Network::Mutation>& mutations) {
+            for (const auto& mutation : mutations)
+                apply(genome, mutation);
+        };
+        static void apply(Genome& genome, const Network::Mutation& m) {
+            // replays one Network::evolve journal entry, positions shift exactly as they did in the pointer graph
+            auto& layers = genome.layers;
+            auto rewire = [&layers](auto&& keep) { // <keep> may move a synapse, and drops it by returning false
+                for (auto& layer : layers)
+                    for (auto& neuron : layer) {
+                        auto& synapses = neuron.synapses;
+                        std::size_t n = 0;
+                        for (auto& synapse : synapses)
+                            if (keep(synapse))
+                                synapses[n++] = synapse;
+                        synapses.resize(n);
+                    }
+            };
+            auto exists = [&layers](const int depth, const int height) {
+                return depth >= 0 && depth < static_cast<int>(layers.size()) && height >= 0 && height < static_cast<int>(layers[depth].size());
+            };
+            auto incoming = [](Genome::Neuron& neuron, const Network::Mutation& m) {
+                return std::find_if(neuron.synapses.begin(), neuron.synapses.end(), [&m](const Genome::Synapse& synapse) {
+                    return synapse.depth == m.sourceDepth && synapse.height == m.sourceHeight;
+                });
+            };
+
+            const int size = layers.size();
+            const bool valid =
+                m.kind == Network::Mutation::AddLayer ? m.depth >= 0 && m.depth <= size :
+                m.kind == Network::Mutation::RemoveLayer ? m.depth >= 0 && m.depth < size :
+                m.kind == Network::Mutation::AddNeuron ? m.depth >= 0 && m.depth < size && m.height >= 0 && m.height <= static_cast<int>(layers[m.depth].size()) :
+                exists(m.depth, m.height) && (!linked(m.kind) || exists(m.sourceDepth, m.sourceHeight));
+            if (!valid)
+                throw std::runtime_error("Storage::apply: mutation outside the genome.");
+
+            switch (m.kind) {
+                case Network::Mutation::AddLayer:
+                    layers.insert(layers.begin() + m.depth, std::vector<Genome::Neuron>{ });
+                    rewire([&m](Genome::Synapse& s) { s.depth += s.depth >= m.depth; return true; });
+                    break;
+                case Network::Mutation::RemoveLayer:
+                    layers.erase(layers.begin() + m.depth);
+                    rewire([&m](Genome::Synapse& s) {
+                        if (s.depth == m.depth)
+                            return false;
+                        s.depth -= s.depth > m.depth;
+                        return true;
+                    });
+                    break;
+                case Network::Mutation::AddNeuron:
+                    layers[m.depth].insert(layers[m.depth].begin() + m.height, Genome::Neuron{ m.value, { } });
+                    rewire([&m](Genome::Synapse& s) { s.height += s.depth == m.depth && s.height >= m.height; return true; });
+                    break;
+                case Network::Mutation::RemoveNeuron:
+                    layers[m.depth].erase(layers[m.depth].begin() + m.height);
+                    rewire([&m](Genome::Synapse& s) {
+                        if (s.depth != m.depth)
+                            return true;
+                        if (s.height == m.height)
+                            return false;
+                        s.height -= s.height > m.height;
+                        return true;
+                    });
+                    break;
+                case Network::Mutation::Bias:
+                    layers[m.depth][m.height].bias = m.value;
+                    break;
+                case Network::Mutation::AddSynapse: {
+                    auto& neuron = layers[m.depth][m.height];
+                    const auto it = incoming(neuron, m);
+                    if (it != neuron.synapses.end())
+                        it->weight = m.value; // re-adding replaces, as in the pointer graph
+                    else
+                        neuron.synapses.push_back({ m.sourceDepth, m.sourceHeight, m.value });
+                    break;
+                }
+                case Network::Mutation::RemoveSynapse:
+                case Network::Mutation::Weight: {
+                    auto& neuron = layers[m.depth][m.height];
+                    const auto it = incoming(neuron, m);
+                    if (it == neuron.synapses.end())
+                        throw std::runtime_error("Storage::apply: no such synapse.");
+
+                    if (m.kind == Network::Mutation::Weight)
+                        it->weight = m.value;
+                    else
+                        neuron.synapses.erase(it);
+                    break;
+                }
+            }
+        };
+
+        static Genome decode(const char* data, const std::size_t size, const std::uint16_t flags = 0) {
+            Reader reader(data, size);
+            Decoder decoder;
+            parse(reader, decoder, normalize(flags));
+            return decoder.genome;
+        };
+
+        static Genome capture(const Network& network) {
+            Genome genome;
+            capture(network, genome);
+            return genome;
+        };
+        static void capture(const Network& network, Genome& genome) { // reuses the vectors <genome> already holds
+            capture(network.get_genome(), network._export(), genome);
+        };
+        static void capture(const ::Genome& source, const Network::ImportExport& data, Genome& genome) {
+            genome.index = data.index;
+            genome.fitSum = data.fitSum, genome.fitCount = data.fitCount;
+            genome.alive = data.status == Network::Alive;
+
+            const auto positions = source.get_positions();
+            genome.layers.resize(source.get_size());
+            for (int depth = 0; depth < source.get_size(); depth++) {
+                auto& neurons = genome.layers[depth];
+                neurons.resize(source.get_size(depth));
+
+                for (int height = 0; height < source.get_size(depth); height++) {
+                    const auto& neuron = source.get_neuron(depth, height);
+                    auto& copy = neurons[height];
+                    copy.bias = neuron.bias;
+                    copy.synapses.clear();
+
+                    for (const auto& synapse : neuron.synapses) {
+                        const auto [ d, h ] = positions.at(synapse.source);
+                        copy.synapses.push_back({ d, h, synapse.weight });
+                    }
+                }
+            }
+        };
+
+        static void header(Writer& writer, const std::uint64_t fingerprint, const int generation, const std::uint64_t count, const std::uint16_t flags = 0) {
+            writer.put(MAGIC);
+            writer.put(VERSION);
+            writer.put(flags);
+            writer.put(fingerprint);
+
+            std::vector<char> out;
+            varint(out, generation);
+            varint(out, count);
+            writer.put(out.data(), out.size());
+        };
+        static void record(Writer& writer, const Genome& genome, std::vector<char>& scratch, const std::uint16_t flags = 0) {
+            scratch.clear();
+            encode(scratch, genome, normalize(flags));
+
+            writer.put(static_cast<std::uint32_t>(scratch.size()));
+            writer.put(scratch.data(), scratch.size());
+        };
+
+        static std::size_t save(const std::string path, const Population& population, const std::uint16_t flags = 0) {
+            std::vector<const Network*> networks;
+            for (const auto& network : population.networks)
+                networks.push_back(&network);
+            return save(path, population, networks, flags);
+        };
+        static std::size_t save(const std::string path, const Population& population, const std::vector<const Network*> networks, std::uint16_t flags = 0) {
+            flags = normalize(flags) & ~DELTA;
+
+            Writer writer(path);
+            header(writer, population.configuration().fingerprint(), population.generation(), networks.size(), flags);
+
+            std::vector<char> scratch; // reused per network
+            for (const auto network : networks)
+                record(writer, capture(*network), scratch, flags);
+
+            writer.close();
+            return writer.size();
+        };
+        static int load(const std::string path, Population& population) {
+            if (population._status != Population::OFF)
+                throw std::runtime_error("Storage::load: population already started.");
+
+            const Mapping mapping(path);
+            return load(mapping.data(), mapping.size(), population);
+        };
+        static int load(const char* bytes, const std::size_t length, Population& population) { // a checkpoint held in memory, trailing bytes are ignored
+            if (population._status != Population::OFF)
+                throw std::runtime_error("Storage::load: population already started.");
+
+            Reader reader(bytes, length);
+
+            // the header is checked up front, records lazily while they are rebuilt
+            const Header head = check(reader, population.configuration().fingerprint());
+            if (head.flags & DELTA)
+                throw std::runtime_error("Storage::load: delta checkpoints are loaded through a Chain.");
+            const auto records = table(reader, head.count);
+
+            std::vector<double> costs;
+            for (const auto& [ data, size ] : records)
+                costs.push_back(size);
+
+            install(population, head.generation, costs, [&records, &head](const int i, Network& network) {
+                const auto [ data, size ] = records[i];
+                Reader record(data, size);
+                Builder builder{ network, { }, { } };
+                parse(record, builder, head.flags);
+                builder.end();
+            });
+            return head.count;
+        };
+
+        static std::vector<Genome> read(const std::string path, const std::uint64_t fingerprint, const std::vector<Genome>& base = { }) {
+            const Mapping mapping(path);
+            Reader reader(mapping.data(), mapping.size());
+
+            const Header head = check(reader, fingerprint);
+            std::vector<Genome> genomes;
+            genomes.reserve(head.count);
+            for (const auto& [ data, size ] : table(reader, head.count)) {
+                Reader record(data, size);
+                genomes.push_back(head.flags & DELTA ? delta(record, base, head.flags) : decode(data, size, head.flags));
+            }
+            return genomes;
+        };
+
+        class Chain { // full keyframes every <interval> generations, journaled deltas in between
+            private:
+                const std::filesystem::path directory;
+                const int interval;
+                const std::uint16_t flags;
+
+                std::atomic<int> keyframe{ -1 };
+                int last = -1;
+
+                std::thread compactor;
+                std::atomic<bool> compacting{ false };
+                std::mutex mutex; // guards <error>, which the compactor sets while save() may be reading it
+                std::exception_ptr error;
+
+                void compact(const std::uint64_t fingerprint, const int generation) {
+                    // folds the deltas since the last keyframe into a new one, off the training thread
+                    try {
+                        const auto genomes = restore(directory, fingerprint, generation);
+                        const auto temp = path(directory, generation, false).string()+".tmp";
+                        {
+                            Writer writer(temp);
+                            header(writer, fingerprint, generation, genomes.size(), flags);
+
+                            std::vector<char> scratch;
+                            for (const auto& genome : genomes)
+                                record(writer, genome, scratch, flags);
+                            writer.sync();
+                        }
+                        std::filesystem::rename(temp, path(directory, generation, false));
+                        keyframe = generation;
+
+                        // the deltas back to the previous keyframe are folded in now
+                        for (int g = generation; g >= 0; g--)
+                            if (!std::filesystem::remove(path(directory, g, true)))
+                                break;
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        error = std::current_exception();
+                    }
+                    compacting = false;
                 };
-                static const std::vector<unsigned long long> neuron(const Neuron& neuron) {
-                    const auto data = neuron._export();
-                    return {
-                        encode<short>(ObjectType::neuron),
-                        encode(data.index),
-                        encode(data.depth),
-                        encode(data.height),
-                        encode(data.bias)
-                    };
+                void rethrow() { // a failed compaction surfaces once, on the training thread
+                    std::exception_ptr failure;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        failure = std::exchange(error, nullptr);
+                    }
+                    if (failure)
+                        std::rethrow_exception(failure);
                 };
-                static const std::vector<unsigned long long> layer(const Layer& layer) {
-                    const auto data = layer._export();
-                    return {
-                        encode<short>(ObjectType::layer),
-                        encode(data.index),
-                        encode(data.depth)
-                    };
+
+            public:
+                Chain(const std::filesystem::path dir, const int keyframes = 10, const std::uint16_t format = 0) :
+                    directory(dir), interval(keyframes), flags(normalize(format) & ~DELTA) {
+                    if (interval <= 0)
+                        throw std::invalid_argument("Storage::Chain: invalid keyframe interval.");
+                    std::filesystem::create_directories(directory);
                 };
-                static const std::vector<unsigned long long> network(const Network& network) {
-                    const auto data = network._export();
-                    return {
-                        encode<short>(ObjectType::network),
-                        encode(data.index),
-                    };
+                Chain(const Chain&) = delete;
+                Chain(Chain&&) = delete;
+
+                ~Chain() {
+                    if (compactor.joinable())
+                        compactor.join();
+                };
+
+                static std::filesystem::path path(const std::filesystem::path& dir, const int generation, const bool delta) {
+                    return dir / ("generation-"+std::to_string(generation)+(delta ? ".delta" : ".key"));
+                };
+
+                std::size_t save(const Population& population) {
+                    rethrow();
+
+                    const int generation = population.generation();
+                    const auto fingerprint = population.configuration().fingerprint();
+
+                    std::size_t bytes;
+                    if (last == -1 || generation != last + 1) { // no base to journal against
+                        wait();
+                        bytes = Storage::save(path(directory, generation, false).string(), population, flags);
+                        keyframe = generation;
+                    } else {
+                        bytes = Storage::save_delta(path(directory, generation, true).string(), population, flags);
+                        if (generation - keyframe >= interval && !compacting) {
+                            if (compactor.joinable())
+                                compactor.join();
+                            compacting = true;
+                            compactor = std::thread(&Chain::compact, this, fingerprint, generation);
+                        }
+                    }
+
+                    last = generation;
+                    return bytes;
+                };
+                void wait() {
+                    if (compactor.joinable())
+                        compactor.join();
+                    rethrow();
+                };
+
+                static std::vector<Genome> restore(const std::filesystem::path& dir, const std::uint64_t fingerprint, const int generation) {
+                    int start = generation;
+                    while (start >= 0 && !std::filesystem::exists(path(dir, start, false)))
+                        start--;
+                    if (start < 0)
+                        throw std::runtime_error("Storage::Chain: no keyframe at or before generation "+std::to_string(generation)+".");
+
+                    auto genomes = read(path(dir, start, false), fingerprint);
+                    for (int g = start + 1; g <= generation; g++) {
+                        const auto file = path(dir, g, true);
+                        if (!std::filesystem::exists(file))
+                            throw std::runtime_error("Storage::Chain: missing delta for generation "+std::to_string(g)+".");
+                        genomes = read(file, fingerprint, genomes);
+                    }
+                    return genomes;
+                };
+                static int load(const std::filesystem::path& dir, Population& population) {
+                    int generation = -1;
+                    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+                        const auto name = entry.path().stem().string();
+                        const auto ext = entry.path().extension().string();
+                        if (name.rfind("generation-", 0) == 0 && (ext == ".key" || ext == ".delta"))
+                            generation = std::max(generation, std::stoi(name.substr(11)));
+                    }
+                    if (generation < 0)
+                        throw std::runtime_error("Storage::Chain: no checkpoints in "+dir.string()+".");
+
+                    const auto genomes = restore(dir, population.configuration().fingerprint(), generation);
+
+                    std::vector<double> costs;
+                    for (const auto& genome : genomes) {
+                        double cost = 0;
+                        for (const auto& layer : genome.layers)
+                            for (const auto& neuron : layer)
+                                cost += 1 + neuron.synapses.size();
+                        costs.push_back(cost);
+                    }
+
+                    install(population, generation, costs, [&genomes](const int i, Network& network) {
+                        const auto& genome = genomes[i];
+
+                        std::vector<int> sizes;
+                        for (const auto& layer : genome.layers)
+                            sizes.push_back(layer.size());
+
+                        Builder builder{ network, { }, { } };
+                        builder.begin(genome.index, genome.fitSum, genome.fitCount, genome.alive, sizes);
+                        for (int depth = 0; depth < static_cast<int>(sizes.size()); depth++)
+                            for (int height = 0; height < sizes[depth]; height++) {
+                                const auto& neuron = genome.layers[depth][height];
+                                builder.neuron(depth, height, neuron.bias);
+                                for (const auto& synapse : neuron.synapses)
+                                    builder.synapse(depth, height, synapse.depth, synapse.height, synapse.weight);
+                            }
+                        builder.end();
+                    });
+                    return genomes.size();
+                };
+
+                Chain& operator=(const Chain&) = delete;
+                Chain& operator=(Chain&&) = delete;
+        };
+
+        class Service { // writes checkpoints on a background thread while training continues, keeping the last <retention>
+            private:
+                struct Frozen { // copy-on-write handle, later mutations copy the blocks it holds instead of changing them
+                    ::Genome genome;
+                    Network::ImportExport data;
+                };
+                struct Snapshot {
+                    int generation = -1;
+                    std::uint64_t fingerprint = 0;
+                    std::vector<Frozen> networks;
+                };
+
+                const std::filesystem::path directory;
+                const int retention;
+                const std::uint16_t flags;
+
+                Snapshot front, back; // double buffer: <front> is taken by the caller while the worker writes <back>
+                Genome scratch; // plain copy of the network being written, owned by the worker
+                std::deque<int> kept; // generations on disk, owned by the worker
+
+                std::mutex mutex;
+                std::condition_variable changed;
+                bool busy = false, stopping = false;
+                std::exception_ptr error;
+                std::thread worker;
+
+                void write(const Snapshot& snapshot) {
+                    const auto file = path(directory, snapshot.generation);
+                    const auto temp = file.string()+".tmp";
+                    {
+                        Writer writer(temp);
+                        header(writer, snapshot.fingerprint, snapshot.generation, snapshot.networks.size(), flags);
+
+                        std::vector<char> bytes;
+                        for (const auto& frozen : snapshot.networks) {
+                            capture(frozen.genome, frozen.data, scratch);
+                            record(writer, scratch, bytes, flags);
+                        }
+                        writer.sync();
+                    }
+                    std::filesystem::rename(temp, file); // a checkpoint is either complete or absent
+
+                    kept.erase(std::remove(kept.begin(), kept.end(), snapshot.generation), kept.end());
+                    kept.push_back(snapshot.generation);
+                    while (static_cast<int>(kept.size()) > retention) {
+                        std::filesystem::remove(path(directory, kept.front()));
+                        kept.pop_front();
+                    }
                 };
-                static const std::vector<unsigned long long> population(const Population& population) {
-                    const auto gen = population.generation();
-                    return {
-                        encode<short>(ObjectType::population),
-                        encode(gen)
+                void run() {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (true) {
+                        changed.wait(lock, [this]() { return busy || stopping; });
+                        if (!busy)
+                            return;
+
+                        lock.unlock();
+                        std::exception_ptr failure;
+                        try {
+                            write(back);
+                        } catch (...) {
+                            failure = std::current_exception();
+                        }
+                        back.networks.clear(); // unshares the blocks, so training edits them in place again
+                        lock.lock();
+
+                        if (failure)
+                            error = failure;
+                        busy = false;
+                        changed.notify_all();
+                    }
+                };
+
+            public:
+                Service(const std::filesystem::path dir, const int keep = 3, const std::uint16_t format = 0) :
+                    directory(dir), retention(keep), flags(normalize(format) & ~DELTA) {
+                        if (retention <= 0)
+                            throw std::invalid_argument("Storage::Service: retention must be positive.");
+                        std::filesystem::create_directories(directory);
+
+                        // checkpoints an earlier run left behind count towards retention, the oldest go first
+                        const auto found = generations(directory);
+                        kept.assign(found.begin(), found.end());
+                        worker = std::thread(&Service::run, this);
                     };
+                Service(const Service&) = delete;
+                Service(Service&&) = delete;
+
+                ~Service() { // the checkpoint in flight is finished first
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stopping = true;
+                    }
+                    changed.notify_all();
+                    worker.join();
                 };
-            } call;
-            static struct Type {
-                using population = std::invoke_result_t<decltype(call.population), Population>;
-                using network = std::invoke_result_t<decltype(call.network), Network>;
-                using layer = std::invoke_result_t<decltype(call.layer), Layer>;
-                using neuron = std::invoke_result_t<decltype(call.neuron), Neuron>;
-                using synapse = std::invoke_result_t<decltype(call.synapse), Synapse>;
-            } type;
-        } save;
 
-    public:
-        static const std::vector<std::vector<unsigned long long>> save(const Population& population, const std::vector<Network*> networks) {
-            using DataVector = std::vector<std::vector<unsigned long long>>;
-            DataVector popEN, netEN, layEN, neuEN, synEN;
-
-            popEN.reserve(1);
-            netEN.reserve(networks.size());
-
-            popEN.push_back(save.call.population(population));
-            for (const auto network : networks) {
-                const auto& scope = network->scope;
-                netEN.push_back(save.call.network(*network));
-                for (const auto layer : scope.layers) {
-                    layEN.push_back(save.call.layer(*layer));
-                    for (const auto neuron : scope.neurons.at(layer)) {
-                        neuEN.push_back(save.call.neuron(*neuron));
-                        for (const auto synapse : scope.synapses.list.at(neuron))
-                            synEN.push_back(save.call.synapse(*synapse));
+                static std::filesystem::path path(const std::filesystem::path& dir, const int generation) {
+                    return dir / ("checkpoint-"+std::to_string(generation)+".bin");
+                };
+                static std::vector<int> generations(const std::filesystem::path& dir) { // of the checkpoints in <dir>, ascending
+                    std::vector<int> found;
+                    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+                        const auto name = entry.path().stem().string();
+                        if (entry.path().extension() != ".bin" || name.rfind("checkpoint-", 0) != 0)
+                            continue;
+
+                        int generation;
+                        const auto digits = name.substr(11);
+                        const auto [ end, failed ] = std::from_chars(digits.data(), digits.data() + digits.size(), generation);
+                        if (failed != std::errc() || end != digits.data() + digits.size())
+                            continue; // not one of ours
+
+                        found.push_back(generation);
                     }
-                }
-            }
+                    std::sort(found.begin(), found.end());
+                    return found;
+                };
+                static std::optional<std::filesystem::path> latest(const std::filesystem::path& dir) {
+                    const auto found = generations(dir);
+                    if (found.empty())
+                        return std::nullopt;
+                    return path(dir, found.back());
+                };
+
+                // call at a generation boundary: takes a handle on every genome, then blocks only while the previous checkpoint
+                // is still being written; copying and encoding the genomes is left to the worker
+                void save(const Population& population) {
+                    front.generation = population.generation();
+                    front.fingerprint = population.configuration().fingerprint();
+                    front.networks.clear();
+                    for (const auto& network : population.networks)
+                        front.networks.push_back({ network.get_genome(), network._export() });
+
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [this]() { return !busy; });
+                    if (error)
+                        std::rethrow_exception(std::exchange(error, nullptr));
+
+                    std::swap(front, back);
+                    busy = true;
+                    changed.notify_all();
+                };
+                void wait() {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [this]() { return !busy; });
+                    if (error)
+                        std::rethrow_exception(std::exchange(error, nullptr));
+                };
+                bool pending() {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    return busy;
+                };
 
-            DataVector data; data.reserve(popEN.size() + netEN.size() + layEN.size() + neuEN.size() + synEN.size());
-            data.insert(data.end(), popEN.begin(), popEN.end());
-            data.insert(data.end(), netEN.begin(), netEN.end());
-            data.insert(data.end(), layEN.begin(), layEN.end());
-            data.insert(data.end(), neuEN.begin(), neuEN.end());
-            data.insert(data.end(), synEN.begin(), synEN.end());
-            data.shrink_to_fit();
-            return data;
+                Service& operator=(const Service&) = delete;
+                Service& operator=(Service&&) = delete;
         };
 };
\ No newline at end of file
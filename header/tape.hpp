@@ -0,0 +1,19 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+struct Tape { // what the user callbacks handed a population, filled while a Recorder is attached
+    struct Evaluation {
+        std::vector<double> inputs;
+        double fitness;
+    };
+
+    std::vector<int> calls; // iterations per train call
+    std::vector<std::vector<Evaluation>> networks; // by network index, in evaluation order
+
+    Tape(const int size = 0) : calls(), networks(size) { };
+
+    // one writer per network at a time, as the population never evaluates a network on two workers
+    void add(const int index, std::vector<double> inputs, const double fitness) { networks[index].push_back({ std::move(inputs), fitness }); };
+};
\ No newline at end of file
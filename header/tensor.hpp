@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "../typedef/functions.hpp"
+
+#include "../module/schedule/main.hpp"
+
+#include "dense.hpp"
+
+class Tensor { // networks of one shape stacked per layer, [network][column][row] weights and [network][row] biases
+    private:
+        static constexpr int LANES = 4; // samples side by side, contiguous so they vectorize
+        static constexpr int TILE = 64; // rows whose sums stay in cache while the columns stream past
+
+        ActivationFunction activator;
+
+        int count; // networks
+        std::vector<int> sizes, offsets;
+        std::vector<std::vector<double>> weights, biases;
+        std::vector<std::vector<int>> links; // [network][earlier layer] synapses per layer
+
+        void run(const int network, const int depth, const int samples, std::vector<double>& values) const;
+
+    public:
+        Tensor(const std::vector<const Dense*>& networks, const ActivationFunction& fn);
+
+        int get_count() const;
+        int get_size() const;
+        std::size_t get_memory() const; // bytes
+
+        // every network on every input, as [network][input][output]
+        std::vector<std::vector<std::vector<double>>> evaluate(const std::vector<std::vector<double>>& inputs, const int threads = 1) const;
+};
\ No newline at end of file
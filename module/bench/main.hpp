@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// self-contained benchmark harness: cases are timed in auto-sized batches and
+// reported as a table on stdout and, optionally, as json for regression tracking
+class Bench {
+    public:
+        using Parameters = std::vector<std::tuple<std::string, long long>>;
+
+        struct Options {
+            std::string filter = ""; // runs the cases whose name contains it
+            std::string json = ""; // path of the machine-readable results, none when empty
+            double time = 5e-2; // seconds a batch should last
+            int repetitions = 5;
+        };
+        struct Result {
+            std::string name;
+            Parameters parameters;
+            long long iterations = 0; // per batch
+            long long items = 1; // per iteration, times are per item
+            double mean = 0, median = 0, min = 0, max = 0, deviation = 0; // nanoseconds
+        };
+
+        class State {
+            private:
+                using Clock = std::chrono::steady_clock;
+
+                const Options& options;
+                Result& result;
+
+                void measure(const std::function<double(const long long)>& batch) {
+                    long long n = 1;
+                    for (double elapsed = batch(n); elapsed < options.time && n < (1LL << 40); elapsed = batch(n))
+                        n = elapsed <= 0 ? n * 10 : std::max(n + 1, std::min(n * 10, static_cast<long long>(n * options.time / elapsed * 1.2)));
+
+                    std::vector<double> samples;
+                    for (int r = 0; r < options.repetitions; r++)
+                        samples.push_back(batch(n) * 1e+9 / n / result.items);
+                    std::sort(samples.begin(), samples.end());
+
+                    const double size = samples.size();
+                    result.iterations = n;
+                    result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / size;
+                    result.median = samples[samples.size() / 2];
+                    result.min = samples.front(), result.max = samples.back();
+
+                    double m2 = 0;
+                    for (const double sample : samples)
+                        m2 += (sample - result.mean) * (sample - result.mean);
+                    result.deviation = size > 1 ? std::sqrt(m2 / (size - 1)) : 0;
+                };
+
+            public:
+                State(const Options& o, Result& r) : options(o), result(r) { };
+
+                long long get(const std::string& name) const {
+                    for (const auto& [ key, value ] : result.parameters)
+                        if (key == name)
+                            return value;
+                    throw std::invalid_argument("Bench::State::get: unknown parameter "+name+".");
+                };
+                void items(const long long n) { result.items = std::max(1LL, n); };
+
+                template <typename F>
+                void run(F&& body) {
+                    measure([&body](const long long n) {
+                        const auto start = Clock::now();
+                        for (long long i = 0; i < n; i++)
+                            body();
+                        return std::chrono::duration<double>(Clock::now() - start).count();
+                    });
+                };
+                template <typename S, typename F>
+                void run(S&& setup, F&& body) { // <setup> runs before every iteration, outside the clock
+                    measure([&setup, &body](const long long n) {
+                        double elapsed = 0;
+                        for (long long i = 0; i < n; i++) {
+                            setup();
+                            const auto start = Clock::now();
+                            body();
+                            elapsed += std::chrono::duration<double>(Clock::now() - start).count();
+                        }
+                        return elapsed;
+                    });
+                };
+        };
+
+    private:
+        struct Case {
+            std::string name;
+            Parameters parameters;
+            std::function<void(State&)> body;
+        };
+
+        Options options;
+        std::vector<Case> cases;
+        std::vector<Result> results;
+
+        static std::string label(const Result& result) {
+            std::string text = result.name;
+            for (const auto& [ key, value ] : result.parameters)
+                text += "/"+key+":"+std::to_string(value);
+            return text;
+        };
+        static std::string escape(const std::string& text) {
+            std::string out;
+            for (const char c : text)
+                if (c == '"' || c == '\\')
+                    out += std::string("\\")+c;
+                else
+                    out += c;
+            return out;
+        };
+
+    public:
+        Bench() : Bench(Options()) { };
+        Bench(const Options o) : options(o), cases(), results() {
+            if (options.time <= 0 || options.repetitions <= 0)
+                throw std::invalid_argument("Bench: time and repetitions must be positive.");
+        };
+        Bench(const int argc, char** argv) : Bench(parse(argc, argv)) { };
+
+        // --filter <text> --json <path> --time <seconds> --repetitions <n>
+        static Options parse(const int argc, char** argv) {
+            Options options;
+            for (int i = 1; i < argc; i++) {
+                const std::string arg = argv[i];
+                if (i + 1 >= argc)
+                    throw std::invalid_argument("Bench: missing value for "+arg+".");
+
+                const std::string value = argv[++i];
+                if (arg == "--filter")
+                    options.filter = value;
+                else if (arg == "--json")
+                    options.json = value;
+                else if (arg == "--time")
+                    options.time = std::stod(value);
+                else if (arg == "--repetitions")
+                    options.repetitions = std::stoi(value);
+                else
+                    throw std::invalid_argument("Bench: unknown option "+arg+".");
+            }
+            return options;
+        };
+
+        template <typename F>
+        void add(const std::string name, const Parameters parameters, F&& body) {
+            cases.push_back({ name, parameters, std::forward<F>(body) });
+        };
+        // every combination of the values, the body reads them back through State::get
+        template <typename F>
+        void grid(const std::string name, const std::vector<std::tuple<std::string, std::vector<long long>>>& axes, F&& body) {
+            std::vector<std::size_t> at(axes.size(), 0);
+            while (true) {
+                Parameters parameters;
+                for (std::size_t a = 0; a < axes.size(); a++)
+                    parameters.push_back({ std::get<0>(axes[a]), std::get<1>(axes[a]).at(at[a]) });
+                cases.push_back({ name, parameters, body });
+
+                std::size_t a = 0;
+                while (a < axes.size() && ++at[a] == std::get<1>(axes[a]).size())
+                    at[a++] = 0;
+                if (a == axes.size())
+                    break;
+            }
+        };
+
+        const std::vector<Result>& run() {
+            std::printf("%-48s %12s %12s %12s %10s\n", "case", "iterations", "median ns", "min ns", "deviation");
+            for (const auto& c : cases) {
+                if (c.name.find(options.filter) == std::string::npos)
+                    continue;
+
+                Result& result = results.emplace_back(Result{ c.name, c.parameters });
+                State state(options, result);
+                c.body(state);
+
+                std::printf("%-48s %12lld %12.1f %12.1f %9.1f%%\n", label(result).c_str(), result.iterations,
+                    result.median, result.min, result.mean > 0 ? 100 * result.deviation / result.mean : 0);
+                std::fflush(stdout);
+            }
+
+            if (!options.json.empty())
+                write(options.json);
+            return results;
+        };
+
+        void write(const std::string& path) const {
+            std::ofstream out(path);
+            if (!out)
+                throw std::runtime_error("Bench::write: could not open "+path+".");
+
+            out << "{\n    \"repetitions\": " << options.repetitions << ",\n    \"results\": [";
+            for (std::size_t i = 0; i < results.size(); i++) {
+                const Result& result = results[i];
+                out << (i == 0 ? "\n" : ",\n") << "        { \"name\": \"" << escape(result.name) << "\", \"parameters\": {";
+                for (std::size_t p = 0; p < result.parameters.size(); p++)
+                    out << (p == 0 ? " \"" : ", \"") << escape(std::get<0>(result.parameters[p])) << "\": " << std::get<1>(result.parameters[p]);
+                out << " }, \"iterations\": " << result.iterations << ", \"items\": " << result.items
+                    << ", \"mean\": " << result.mean << ", \"median\": " << result.median
+                    << ", \"min\": " << result.min << ", \"max\": " << result.max << ", \"deviation\": " << result.deviation << " }";
+            }
+            out << "\n    ]\n}\n";
+        };
+
+        template <typename T>
+        static void keep(const T& value) { // stops the compiler from discarding a result
+            #if defined(__GNUC__) || defined(__clang__)
+                asm volatile("" : : "r,m"(value) : "memory");
+            #else
+                static volatile const void* sink;
+                sink = &value;
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            #endif
+        };
+};
\ No newline at end of file
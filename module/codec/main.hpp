@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+class Codec { // self-contained integer and floating point coders, <R> is any reader with skip(bytes) -> const char*
+    public:
+        static std::uint64_t zigzag(const std::int64_t n) { return (static_cast<std::uint64_t>(n) << 1) ^ static_cast<std::uint64_t>(n >> 63); };
+        static std::int64_t unzigzag(const std::uint64_t n) { return static_cast<std::int64_t>(n >> 1) ^ -static_cast<std::int64_t>(n & 1); };
+
+        static void varint(std::vector<char>& out, std::uint64_t n) {
+            while (n >= 0x80) {
+                out.push_back(static_cast<char>(n | 0x80));
+                n >>= 7;
+            }
+            out.push_back(static_cast<char>(n));
+        };
+        template <typename R>
+        static std::uint64_t varint(R& reader) {
+            std::uint64_t n = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const auto byte = static_cast<unsigned char>(*reader.skip(1));
+                n |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                    return n;
+            }
+            throw std::runtime_error("Codec::varint: malformed varint.");
+        };
+
+        static void svarint(std::vector<char>& out, const std::int64_t n) { varint(out, zigzag(n)); };
+        template <typename R>
+        static std::int64_t svarint(R& reader) { return unzigzag(varint(reader)); };
+
+        class Bits { // append-only bit stream, most significant bit first
+            private:
+                std::vector<char> bytes;
+                int free = 0; // unused bits in the last byte
+
+            public:
+                void put(const std::uint64_t value, int count) {
+                    while (count > 0) {
+                        if (free == 0) {
+                            bytes.push_back(0);
+                            free = 8;
+                        }
+                        const int n = std::min(count, free);
+                        const auto chunk = static_cast<unsigned char>((value >> (count - n)) & ((1u << n) - 1));
+                        bytes.back() = static_cast<char>(static_cast<unsigned char>(bytes.back()) | chunk << (free - n));
+                        count -= n, free -= n;
+                    }
+                };
+
+                void clear() {
+                    bytes.clear();
+                    free = 0;
+                };
+                const std::vector<char>& data() const { return bytes; };
+        };
+        class BitReader {
+            private:
+                const unsigned char* at;
+                const unsigned char* end;
+                int used = 0; // bits already read from <at>
+
+            public:
+                BitReader(const char* data, const std::size_t size) :
+                    at(reinterpret_cast<const unsigned char*>(data)), end(reinterpret_cast<const unsigned char*>(data) + size) { };
+
+                std::uint64_t get(int count) {
+                    std::uint64_t value = 0;
+                    while (count > 0) {
+                        if (at == end)
+                            throw std::runtime_error("Codec::BitReader: truncated stream.");
+
+                        const int n = std::min(count, 8 - used);
+                        value = value << n | ((*at >> (8 - used - n)) & ((1u << n) - 1));
+                        count -= n, used += n;
+                        if (used == 8)
+                            at++, used = 0;
+                    }
+                    return value;
+                };
+        };
+
+        class Floats { // Chimp-style XOR coding: every value is XORed with a reference and only its meaningful bits are kept
+            private:
+                static constexpr int LEADS[8] = { 0, 8, 12, 16, 18, 20, 22, 24 }; // leading zeros are rounded down to these
+
+                std::uint64_t previous = 0;
+                int lead = -1; // bucket of the last value
+                bool single;
+
+                int width() const { return single ? 32 : 64; };
+                static std::uint64_t mask(const int count) { return count == 64 ? ~0ULL : (1ULL << count) - 1; };
+
+                // the sign moves to the lowest bit, so values of similar magnitude share their leading bits
+                std::uint64_t pack(const double value) const {
+                    const std::uint64_t bits = single ? std::bit_cast<std::uint32_t>(static_cast<float>(value)) : std::bit_cast<std::uint64_t>(value);
+                    return (bits << 1 | bits >> (width() - 1)) & mask(width());
+                };
+                double unpack(const std::uint64_t packed) const {
+                    const std::uint64_t bits = (packed >> 1 | packed << (width() - 1)) & mask(width());
+                    return single ? static_cast<double>(std::bit_cast<float>(static_cast<std::uint32_t>(bits))) : std::bit_cast<double>(bits);
+                };
+                static int bucket(const int zeros) {
+                    int b = 0;
+                    while (b < 7 && LEADS[b + 1] <= zeros)
+                        b++;
+                    return b;
+                };
+
+            public:
+                Floats(const bool float32 = false) : single(float32) { };
+
+                void against(const double reference) { previous = pack(reference); }; // the next value is coded relative to <reference>
+
+                // 00: same as the reference
+                // 01: 3 bit leading bucket, 6 bit length, then the bits between leading and trailing zeros
+                // 10: same leading bucket as the last value, then everything after it
+                // 11: 3 bit leading bucket, then everything after it
+                void put(Bits& out, const double value) {
+                    const std::uint64_t bits = pack(value), x = bits ^ previous;
+                    previous = bits;
+
+                    if (x == 0) {
+                        out.put(0b00, 2);
+                        return;
+                    }
+                    const int b = bucket(std::countl_zero(x) - (64 - width())), trail = std::countr_zero(x);
+                    const int center = width() - LEADS[b] - trail;
+                    if (trail > 6) {
+                        out.put(0b01, 2);
+                        out.put(b, 3);
+                        out.put(center - 1, 6);
+                        out.put(x >> trail, center);
+                    } else if (b == lead) {
+                        out.put(0b10, 2);
+                        out.put(x, width() - LEADS[b]);
+                    } else {
+                        out.put(0b11, 2);
+                        out.put(b, 3);
+                        out.put(x, width() - LEADS[b]);
+                        lead = b;
+                    }
+                };
+                double get(BitReader& in) {
+                    switch (in.get(2)) {
+                        case 0b01: {
+                            const int b = in.get(3), center = in.get(6) + 1;
+                            if (LEADS[b] + center > width())
+                                throw std::runtime_error("Codec::Floats: malformed value.");
+                            previous ^= in.get(center) << (width() - LEADS[b] - center);
+                            break;
+                        }
+                        case 0b10:
+                            if (lead < 0)
+                                throw std::runtime_error("Codec::Floats: malformed value.");
+                            previous ^= in.get(width() - LEADS[lead]);
+                            break;
+                        case 0b11:
+                            lead = in.get(3);
+                            previous ^= in.get(width() - LEADS[lead]);
+                            break;
+                    }
+                    return unpack(previous);
+                };
+        };
+};
\ No newline at end of file
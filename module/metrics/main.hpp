@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// counters, gauges and hdr-style histograms, updated lock-free and exported as prometheus text
+class Metrics {
+    public:
+        class Counter {
+            private:
+                std::atomic<std::uint64_t> value{ 0 };
+
+            public:
+                void add(const std::uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); };
+                void raise(const std::uint64_t n) { // to at least <n>, mirroring a tally kept elsewhere
+                    std::uint64_t current = get();
+                    while (current < n && !value.compare_exchange_weak(current, n, std::memory_order_relaxed));
+                };
+                std::uint64_t get() const { return value.load(std::memory_order_relaxed); };
+        };
+        class Gauge {
+            private:
+                std::atomic<double> value{ 0 };
+
+            public:
+                void set(const double v) { value.store(v, std::memory_order_relaxed); };
+                double get() const { return value.load(std::memory_order_relaxed); };
+        };
+
+        // log-linear buckets: every power of two is split into 2^PRECISION buckets, so a recorded
+        // value is off by at most 1 / 2^PRECISION (about 3%), from 1 up to 2^RANGE
+        class Histogram {
+            public:
+                static constexpr int PRECISION = 5, RANGE = 44; // nanoseconds: up to about 4.9 hours
+                static constexpr int SUB = 1 << PRECISION;
+                static constexpr int SIZE = (RANGE - PRECISION + 1) * SUB;
+
+                static int index(std::uint64_t value) {
+                    value = std::min(value, (std::uint64_t(1) << RANGE) - 1);
+                    if (value < SUB)
+                        return value;
+
+                    const int exponent = std::bit_width(value) - 1;
+                    const int shift = exponent - PRECISION;
+                    return (shift + 1) * SUB + static_cast<int>((value >> shift) - SUB);
+                };
+                static std::uint64_t lower(const int index) { // smallest value landing in <index>
+                    if (index < SUB)
+                        return index;
+                    const int shift = index / SUB - 1;
+                    return (static_cast<std::uint64_t>(SUB + index % SUB)) << shift;
+                };
+
+                class Timer { // records the nanoseconds it lived
+                    private:
+                        Histogram& histogram;
+                        const std::chrono::steady_clock::time_point start;
+
+                    public:
+                        Timer(Histogram& h) : histogram(h), start(std::chrono::steady_clock::now()) { };
+                        Timer(const Timer&) = delete;
+                        ~Timer() { histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()); };
+
+                        Timer& operator=(const Timer&) = delete;
+                };
+
+            private:
+                std::unique_ptr<std::atomic<std::uint64_t>[]> buckets;
+                std::atomic<std::uint64_t> count{ 0 }, sum{ 0 }, max{ 0 };
+
+            public:
+                const double scale; // exported unit per recorded unit, 1e-9 turns nanoseconds into seconds
+
+                Histogram(const double s = 1) : buckets(new std::atomic<std::uint64_t>[SIZE]), scale(s) {
+                    for (int i = 0; i < SIZE; i++)
+                        buckets[i].store(0, std::memory_order_relaxed);
+                };
+
+                void record(const std::uint64_t value) {
+                    buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    sum.fetch_add(value, std::memory_order_relaxed);
+
+                    std::uint64_t seen = max.load(std::memory_order_relaxed);
+                    while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed));
+                };
+                Timer time() { return Timer(*this); };
+
+                std::vector<std::uint64_t> counts() const {
+                    std::vector<std::uint64_t> copy(SIZE);
+                    for (int i = 0; i < SIZE; i++)
+                        copy[i] = buckets[i].load(std::memory_order_relaxed);
+                    return copy;
+                };
+                std::uint64_t get_count() const { return count.load(std::memory_order_relaxed); };
+                std::uint64_t get_sum() const { return sum.load(std::memory_order_relaxed); };
+                std::uint64_t get_max() const { return max.load(std::memory_order_relaxed); };
+        };
+
+        struct Snapshot {
+            struct Sample {
+                std::string name, labels;
+                double value;
+            };
+            struct Distribution {
+                std::string name, labels;
+                std::uint64_t count;
+                double sum, max; // scaled
+                double p50 = 0, p90 = 0, p99 = 0, p999 = 0;
+                std::vector<std::tuple<double, std::uint64_t>> buckets = { }; // cumulative count at or under each power-of-two bound less one, scaled
+            };
+
+            std::vector<Sample> counters, gauges;
+            std::vector<Distribution> histograms;
+            std::map<std::string, std::string> help;
+
+            std::string prometheus() const {
+                std::ostringstream out;
+                out.precision(9);
+
+                std::string last = "";
+                auto family = [&out, &last, this](const std::string& name, const char* type) {
+                    if (name == last)
+                        return;
+                    last = name;
+                    const auto it = help.find(name);
+                    if (it != help.end() && !it->second.empty())
+                        out << "# HELP " << name << " " << it->second << "\n";
+                    out << "# TYPE " << name << " " << type << "\n";
+                };
+                auto braces = [](const std::string& labels, const std::string& extra = "") {
+                    const std::string all = labels.empty() ? extra : extra.empty() ? labels : labels+","+extra;
+                    return all.empty() ? std::string("") : "{"+all+"}";
+                };
+
+                for (const auto& sample : counters) {
+                    family(sample.name, "counter");
+                    out << sample.name << braces(sample.labels) << " " << sample.value << "\n";
+                }
+                for (const auto& sample : gauges) {
+                    family(sample.name, "gauge");
+                    out << sample.name << braces(sample.labels) << " " << sample.value << "\n";
+                }
+                for (const auto& histogram : histograms) {
+                    family(histogram.name, "histogram");
+                    for (const auto& [ bound, below ] : histogram.buckets) {
+                        std::ostringstream le;
+                        le.precision(9);
+                        le << "le=\"" << bound << "\"";
+                        out << histogram.name << "_bucket" << braces(histogram.labels, le.str()) << " " << below << "\n";
+                    }
+                    out << histogram.name << "_bucket" << braces(histogram.labels, "le=\"+Inf\"") << " " << histogram.count << "\n";
+                    out << histogram.name << "_sum" << braces(histogram.labels) << " " << histogram.sum << "\n";
+                    out << histogram.name << "_count" << braces(histogram.labels) << " " << histogram.count << "\n";
+                }
+                return out.str();
+            };
+
+            void write(const std::string& path) const { // through a temporary file, so a scraper never reads half of it
+                const std::string temp = path+".tmp";
+                {
+                    std::ofstream out(temp, std::ios::trunc);
+                    if (!out)
+                        throw std::runtime_error("Metrics::write: could not open "+temp+".");
+                    out << prometheus();
+                    if (!out.flush())
+                        throw std::runtime_error("Metrics::write: could not write "+temp+".");
+                }
+                std::filesystem::rename(temp, path);
+            };
+        };
+
+    private:
+        using Key = std::tuple<std::string, std::string>; // name, labels as in name{labels}
+
+        mutable std::mutex lock; // guards registration only, instruments are updated without it
+        std::map<Key, std::unique_ptr<Counter>> counters;
+        std::map<Key, std::unique_ptr<Gauge>> gauges;
+        std::map<Key, std::unique_ptr<Histogram>> histograms;
+        std::map<std::string, std::string> help;
+
+        static void check(const std::string& name) {
+            if (name.empty() || !std::all_of(name.begin(), name.end(), [](const char c) {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':';
+            }) || (name[0] >= '0' && name[0] <= '9'))
+                throw std::invalid_argument("Metrics: invalid metric name "+name+".");
+        };
+        template <typename T, typename... Args>
+        T& find(std::map<Key, std::unique_ptr<T>>& map, const std::string& name, const std::string& labels, const std::string& text, Args... args) {
+            check(name);
+            std::lock_guard<std::mutex> guard(lock);
+            if (!text.empty())
+                help.insert_or_assign(name, text);
+
+            auto& slot = map[{ name, labels }];
+            if (slot == nullptr)
+                slot = std::make_unique<T>(args...);
+            return *slot;
+        };
+
+        static double quantile(const std::vector<std::uint64_t>& counts, const std::uint64_t total, const double q) {
+            if (total == 0)
+                return 0;
+
+            const auto rank = static_cast<std::uint64_t>(std::ceil(q * total));
+            std::uint64_t seen = 0;
+            for (int i = 0; i < Histogram::SIZE; i++)
+                if ((seen += counts[i]) >= std::max<std::uint64_t>(rank, 1))
+                    return (Histogram::lower(i) + (i + 1 < Histogram::SIZE ? Histogram::lower(i + 1) : Histogram::lower(i))) / 2.0; // bucket midpoint
+            return Histogram::lower(Histogram::SIZE - 1);
+        };
+
+    public:
+        Metrics() : counters(), gauges(), histograms(), help() { };
+        Metrics(const Metrics&) = delete;
+
+        // the same name and labels give back the same instrument, keep the reference on hot paths
+        Counter& counter(const std::string& name, const std::string& labels = "", const std::string& text = "") { return find(counters, name, labels, text); };
+        Gauge& gauge(const std::string& name, const std::string& labels = "", const std::string& text = "") { return find(gauges, name, labels, text); };
+        Histogram& histogram(const std::string& name, const std::string& labels = "", const std::string& text = "", const double scale = 1) {
+            return find(histograms, name, labels, text, scale);
+        };
+
+        Snapshot snapshot() const {
+            std::lock_guard<std::mutex> guard(lock);
+
+            Snapshot snapshot;
+            snapshot.help = help;
+            for (const auto& [ key, counter ] : counters)
+                snapshot.counters.push_back({ std::get<0>(key), std::get<1>(key), static_cast<double>(counter->get()) });
+            for (const auto& [ key, gauge ] : gauges)
+                snapshot.gauges.push_back({ std::get<0>(key), std::get<1>(key), gauge->get() });
+
+            for (const auto& [ key, histogram ] : histograms) {
+                const auto counts = histogram->counts();
+                std::uint64_t total = 0;
+                for (const auto c : counts)
+                    total += c;
+
+                const double scale = histogram->scale;
+                Snapshot::Distribution d{ std::get<0>(key), std::get<1>(key), total, histogram->get_sum() * scale, histogram->get_max() * scale };
+                d.p50 = quantile(counts, total, 0.5) * scale;
+                d.p90 = quantile(counts, total, 0.9) * scale;
+                d.p99 = quantile(counts, total, 0.99) * scale;
+                d.p999 = quantile(counts, total, 0.999) * scale;
+
+                // prometheus buckets at every power of two between the smallest and largest value seen; values are
+                // integers, so those below 2^e are exactly those at or under 2^e - 1, which is the exported le
+                int first = -1, last = -1;
+                for (int i = 0; i < Histogram::SIZE; i++)
+                    if (counts[i] > 0)
+                        last = i, first = first < 0 ? i : first;
+                if (first >= 0) {
+                    std::uint64_t below = 0;
+                    int i = 0;
+                    for (int e = 0; e <= Histogram::RANGE; e++) {
+                        const std::uint64_t bound = std::uint64_t(1) << e;
+                        for (; i < Histogram::SIZE && Histogram::lower(i) < bound; i++)
+                            below += counts[i];
+                        if (bound > Histogram::lower(first) && bound / 2 <= Histogram::lower(last))
+                            d.buckets.push_back({ (bound - 1) * scale, below });
+                    }
+                }
+                snapshot.histograms.push_back(d);
+            }
+            return snapshot;
+        };
+
+        Metrics& operator=(const Metrics&) = delete;
+};
\ No newline at end of file
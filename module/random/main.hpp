@@ -3,31 +3,145 @@
 #define _USE_MATH_DEFINES
 
 #include <cmath>
+#include <cstdint>
 #include <iterator>
+#include <limits>
 #include <random>
+#include <span>
+#include <vector>
 
 #include "../concepts/main.hpp"
 #include "../math/main.hpp"
 #include "../range/main.hpp"
 
 class Random {
+    private:
+        class Engine { // xoshiro256**
+            private:
+                std::uint64_t state[4];
+
+                static std::uint64_t rotl(const std::uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); };
+
+            public:
+                static std::uint64_t splitmix(std::uint64_t& x) {
+                    std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    return z ^ (z >> 31);
+                };
+
+                Engine(std::uint64_t seed) { reseed(seed); };
+
+                void reseed(std::uint64_t seed) {
+                    for (auto& s : state)
+                        s = splitmix(seed);
+                };
+
+                std::uint64_t next() {
+                    const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+                    const std::uint64_t t = state[1] << 17;
+
+                    state[2] ^= state[0];
+                    state[3] ^= state[1];
+                    state[1] ^= state[2];
+                    state[0] ^= state[3];
+                    state[2] ^= t;
+                    state[3] = rotl(state[3], 45);
+
+                    return result;
+                };
+
+                void jump() { // advances 2^128 draws
+                    static constexpr std::uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+                    std::uint64_t s[4] = { 0, 0, 0, 0 };
+                    for (const auto j : JUMP)
+                        for (int b = 0; b < 64; b++) {
+                            if (j & (std::uint64_t(1) << b))
+                                for (int i = 0; i < 4; i++)
+                                    s[i] ^= state[i];
+                            next();
+                        }
+
+                    for (int i = 0; i < 4; i++)
+                        state[i] = s[i];
+                };
+        };
+
+        static Engine& engine() {
+            thread_local Engine e((std::uint64_t(std::random_device{}()) << 32) ^ std::random_device{}());
+            return e;
+        };
+
+        static std::uint64_t bounded(const std::uint64_t span) { // uniform in [0, span), span 0 means the full 64 bits
+            if (span == 0)
+                return engine().next();
+
+            const std::uint64_t threshold = -span % span;
+            while (true) {
+                const std::uint64_t r = engine().next();
+                if (r >= threshold)
+                    return r % span;
+            }
+        };
+        static double unit() { return (engine().next() >> 11) * 0x1.0p-53; }; // uniform in [0, 1)
+
     public:
+        static std::uint64_t hash(std::uint64_t s, const std::uint64_t n) { return Engine::splitmix(s) ^ (n * 0x9e3779b97f4a7c15ULL); };
+
+        static void seed(const std::uint64_t s) { engine().reseed(s); };
+        static void stream(const std::uint64_t s, const std::uint64_t index) { engine().reseed(hash(s, index)); }; // independent stream <index> of seed <s>
+        static void jump() { engine().jump(); };
+
+        static std::uint64_t bits() { return engine().next(); };
+
+        static std::uint64_t skip(const double chance) { // failed trials before the next success
+            if (chance <= 0)
+                return std::numeric_limits<std::uint64_t>::max();
+            else if (chance >= 1)
+                return 0;
+            const double trials = std::log(1.0 - unit()) / std::log1p(-chance);
+            constexpr double limit = 18446744073709551616.0; // 2^64, past which the cast is undefined
+            return trials < limit ? static_cast<std::uint64_t>(trials) : std::numeric_limits<std::uint64_t>::max();
+        };
+        static std::vector<std::size_t> sample(const std::size_t size, const double chance) { // indices passing a <chance> condition each
+            std::vector<std::size_t> indices;
+            if (chance <= 0)
+                return indices;
+
+            for (std::uint64_t i = skip(chance); i < size; ) {
+                indices.push_back(i);
+                const std::uint64_t gap = skip(chance);
+                i = gap < size - i ? i + gap + 1 : size; // saturates, a maximal gap would wrap around
+            }
+            return indices;
+        };
+
+        static void fill(std::span<double> values) {
+            for (auto& value : values)
+                value = unit();
+        };
+        static void fill(std::span<double> values, const Range<double>& range) {
+            const double mn = range.min(), step = range.step(), width = range.max() + step - mn;
+            for (auto& value : values) {
+                const double rng = mn + unit() * width;
+                value = rng - std::fmod(rng - mn, step);
+            }
+        };
+
         template <typename T>
         static T generate(const Range<T>& range) {
             static_assert(concepts::number::assert<T>(), "Random::generate: range must be a number.");
 
             const T mn = range.min(); const T mx = range.max();
             const T step = range.step();
-        
-            std::random_device rd;
-            std::mt19937 gen(rd());
+
             if constexpr (std::is_integral_v<T>) { // equally generate integers between min and max while on step
-                std::uniform_int_distribution<T> dis(mn, mx);
-                const T rng = dis(gen);
+                const std::uint64_t span = static_cast<std::uint64_t>(mx) - static_cast<std::uint64_t>(mn) + 1;
+                const T rng = static_cast<T>(static_cast<std::uint64_t>(mn) + bounded(span));
                 return rng - (rng - mn) % step;
             } else if constexpr (std::is_floating_point_v<T>) { // equally generate floating point numbers between min and max while on step
-                std::uniform_real_distribution<T> dis(mn, mx + step);
-                const T rng = dis(gen);
+                const T rng = mn + static_cast<T>(unit()) * (mx + step - mn);
                 return rng - fmod(rng - mn, step);
             } else
                 throw std::invalid_argument("Unsupported type for Random.");
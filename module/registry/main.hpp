@@ -1,108 +1,227 @@
 #pragma once
 
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <stdexcept>
-#include <unordered_map>
-#include <unordered_set>
+#include <type_traits>
 
-template <typename T>
+template <typename T, std::size_t Labels = 16>
 class Registry {
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "Registry: labels must be integral.");
+
     private:
+        static constexpr int BASE = 64; // page <p> holds BASE << p slots, so pages never move
+        static constexpr int PAGES = 24;
+        static constexpr std::uint64_t EMPTY = 0;
+
+        struct Slot {
+            std::atomic<unsigned int> generation{ 0 }; // odd while the id is in use
+            std::atomic<int> link{ 0 }; // next free slot + 1
+        };
         struct Group {
-            size_t next = 0;
-            std::unordered_set<int> items;
-            Group() : items() { };
+            std::atomic<Slot*> pages[PAGES];
+            std::atomic<int> next{ 0 }; // slots handed out so far
+            std::atomic<int> size{ 0 };
+            std::atomic<std::uint64_t> free{ EMPTY }; // tag << 32 | slot + 1
+
+            Group() {
+                for (auto& page : pages)
+                    page.store(nullptr);
+            };
+            ~Group() { reset(); };
+
+            void reset() {
+                for (auto& page : pages)
+                    delete[] page.exchange(nullptr);
+                next = 0, size = 0, free = EMPTY;
+            };
+
+            static int page_of(const int id) { return std::bit_width(static_cast<unsigned int>(id / BASE + 1)) - 1; };
+            static int offset_of(const int id, const int page) { return id - BASE * ((1 << page) - 1); };
+
+            Slot* find(const int id) const {
+                if (id < 0 || id >= next.load())
+                    return nullptr;
+
+                const int page = page_of(id);
+                Slot* slots = pages[page].load(std::memory_order_acquire);
+                return slots == nullptr ? nullptr : &slots[offset_of(id, page)];
+            };
+            Slot& make(const int id) {
+                const int page = page_of(id);
+                if (page >= PAGES)
+                    throw std::length_error("Registry: out of ids.");
+
+                Slot* slots = pages[page].load(std::memory_order_acquire);
+                if (slots == nullptr) {
+                    Slot* fresh = new Slot[BASE << page];
+                    if (pages[page].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel))
+                        slots = fresh;
+                    else
+                        delete[] fresh; // another thread won, <slots> now holds its page
+                }
+                return slots[offset_of(id, page)];
+            };
+
+            int pop() {
+                std::uint64_t head = free.load(std::memory_order_acquire);
+                while (true) {
+                    const int index = static_cast<int>(head & 0xffffffffULL) - 1;
+                    if (index < 0)
+                        return -1;
+
+                    const std::uint64_t link = static_cast<std::uint64_t>(find(index)->link.load());
+                    const std::uint64_t tag = (head >> 32) + 1;
+                    if (free.compare_exchange_weak(head, tag << 32 | link, std::memory_order_acq_rel))
+                        return index;
+                }
+            };
+            void push(const int id) {
+                Slot& slot = *find(id);
+                std::uint64_t head = free.load(std::memory_order_acquire);
+                while (true) {
+                    slot.link = static_cast<int>(head & 0xffffffffULL);
+                    const std::uint64_t tag = (head >> 32) + 1;
+                    if (free.compare_exchange_weak(head, tag << 32 | static_cast<std::uint64_t>(id + 1), std::memory_order_acq_rel))
+                        return;
+                }
+            };
+        };
+        Group groups[Labels];
+
+        Group& group(const T label) {
+            const auto index = static_cast<std::size_t>(label);
+            if (index >= Labels)
+                throw std::out_of_range("Registry: label out of range.");
+            return groups[index];
+        };
+        const Group& group(const T label) const {
+            const auto index = static_cast<std::size_t>(label);
+            if (index >= Labels)
+                throw std::out_of_range("Registry: label out of range.");
+            return groups[index];
         };
-        std::unordered_map<T, Group> groups;
 
     public:
+        class const_iterator { // walks the slot pages in id order, skipping free ids
+            private:
+                const Group* group;
+                int id;
+
+                void settle() {
+                    const int end = group->next.load();
+                    while (id < end) {
+                        const Slot* slot = group->find(id);
+                        if (slot != nullptr && slot->generation.load() % 2 == 1)
+                            return;
+                        id++;
+                    }
+                    id = end;
+                };
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = int;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const int*;
+                using reference = int;
+
+                const_iterator(const Group* g, const int i) : group(g), id(i) { settle(); };
+
+                int operator*() const { return id; };
+
+                const_iterator& operator++() {
+                    id++;
+                    settle();
+                    return *this;
+                };
+                const_iterator operator++(int) {
+                    const_iterator temp = *this;
+                    ++(*this);
+                    return temp;
+                };
+
+                bool operator==(const const_iterator& other) const { return id == other.id; };
+                bool operator!=(const const_iterator& other) const { return id != other.id; };
+        };
+
         Registry() : groups() { };
         Registry(const Registry&) = delete;
         Registry(Registry&&) = delete;
 
         ~Registry() { clear(); };
 
-        size_t add(const T label) {
-            if (groups.find(label) == groups.end())
-                groups[label] = Group();
-        
-            Group& group = groups[label];
-            const size_t id = ++group.next;
-            group.items.insert(id);
-        
+        int add(const T label) { // lock-free, safe to call from several threads
+            Group& g = group(label);
+
+            int id = g.pop();
+            if (id < 0)
+                id = g.next.fetch_add(1);
+
+            g.make(id).generation.fetch_add(1);
+            g.size++;
             return id;
         };
 
-        bool has(const T label) const { return groups.find(label) != groups.end(); };
-        bool has(const T label, const size_t id) const {
-            auto it = groups.find(label);
-            if (it == groups.end())
-                return false;
-            return it->second.items.find(id) != it->second.items.end();
+        bool has(const T label) const { return group(label).size.load() > 0; };
+        bool has(const T label, const int id) const {
+            const Slot* slot = group(label).find(id);
+            return slot != nullptr && slot->generation.load() % 2 == 1;
         };
 
-        bool empty() const { return groups.empty(); };
+        unsigned int generation(const T label, const int id) const { // bumped on every add and erase of <id>
+            const Slot* slot = group(label).find(id);
+            if (slot == nullptr)
+                throw std::out_of_range("Registry: id not found.");
+            return slot->generation.load();
+        };
 
-        bool erase(const T label) {
-            auto it = groups.find(label);
-            if (it == groups.end())
-                return false;
-        
-            auto& items = it->second.items;
-            for (auto it2 = items.begin(); it2 != items.end(); ++it2)
-                items.erase(*it2);
-        
-            groups.erase(label);
+        int size(const T label) const { return group(label).size.load(); };
+
+        bool empty() const {
+            for (const auto& g : groups)
+                if (g.size.load() > 0)
+                    return false;
             return true;
         };
-        bool erase(const T label, const size_t id) {
-            auto it = groups.find(label);
-            if (it == groups.end())
-                return false;
-        
-            auto& items = it->second.items;
-            if (items.find(id) == items.end())
+
+        bool erase(const T label) { // not safe against concurrent add on the same label
+            Group& g = group(label);
+            if (g.size.load() == 0)
                 return false;
-        
-            items.erase(id);
-            if (items.empty())
-                groups.erase(label);
-        
+
+            g.reset();
             return true;
         };
+        bool erase(const T label, const int id) {
+            Group& g = group(label);
+            Slot* slot = g.find(id);
+            if (slot == nullptr)
+                return false;
 
-        void clear() {
-            for (auto it = groups.begin(); it != groups.end(); ++it) {
-                auto& items = it->second.items;
-                for (auto it2 = items.begin(); it2 != items.end(); ++it2)
-                    items.erase(*it2);
-            }
-            groups.clear();
-        };
+            unsigned int generation = slot->generation.load();
+            do {
+                if (generation % 2 == 0)
+                    return false;
+            } while (!slot->generation.compare_exchange_weak(generation, generation + 1));
 
-        std::unordered_set<int>::const_iterator begin(const T label) const {
-            auto it = groups.find(label);
-            if (it == groups.end())
-                throw std::out_of_range("Label not found in registry.");
-            return it->second.items.cbegin();
-        };
-        std::unordered_set<int>::const_iterator end(const T label) const {
-            auto it = groups.find(label);
-            if (it == groups.end())
-                throw std::out_of_range("Label not found in registry.");
-            return it->second.items.cend();
+            g.push(id);
+            g.size--;
+            return true;
         };
 
-        std::unordered_set<int>::const_iterator rbegin(const T label) const {
-            auto it = groups.find(label);
-            if (it == groups.end())
-                throw std::out_of_range("Label not found in registry.");
-            return it->second.items.crbegin();
+        void clear() {
+            for (auto& g : groups)
+                g.reset();
         };
-        std::unordered_set<int>::const_iterator rend(const T label) const {
-            auto it = groups.find(label);
-            if (it == groups.end())
-                throw std::out_of_range("Label not found in registry.");
-            return it->second.items.crend();
+
+        const_iterator begin(const T label) const { return const_iterator(&group(label), 0); };
+        const_iterator end(const T label) const {
+            const Group& g = group(label);
+            return const_iterator(&g, g.next.load());
         };
 
         Registry& operator=(const Registry&) = delete;
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class Schedule {
+    private:
+        class Pool { // persistent helpers, so a run costs a wake-up instead of a thread spawn
+            private:
+                std::mutex mutex;
+                std::condition_variable wake;
+                std::deque<std::function<void()>> jobs;
+                std::vector<std::thread> threads;
+                bool stopping = false;
+
+                void loop() {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (true) {
+                        wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                        if (jobs.empty())
+                            return;
+
+                        auto job = std::move(jobs.front());
+                        jobs.pop_front();
+                        lock.unlock();
+                        job();
+                        lock.lock();
+                    }
+                };
+
+            public:
+                Pool() = default;
+                Pool(const Pool&) = delete;
+
+                ~Pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stopping = true;
+                    }
+                    wake.notify_all();
+                    for (auto& thread : threads)
+                        thread.join();
+                };
+
+                void post(const std::function<void()>& job, const int copies) { // grows to <copies> helpers
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        while (static_cast<int>(threads.size()) < copies)
+                            threads.emplace_back(&Pool::loop, this);
+                        for (int i = 0; i < copies; i++)
+                            jobs.push_back(job);
+                    }
+                    wake.notify_all();
+                };
+
+                Pool& operator=(const Pool&) = delete;
+        };
+        static Pool& pool() {
+            static Pool instance;
+            return instance;
+        };
+
+    public:
+        struct Report {
+            double makespan = 0; // measured wall time in seconds
+            double ideal = 0; // lower bound: max(total / workers, longest task)
+            std::vector<double> times; // measured seconds per task, by task index
+        };
+
+        static std::vector<int> order(const std::vector<double>& costs) {
+            std::vector<int> indices(costs.size());
+            std::iota(indices.begin(), indices.end(), 0);
+            std::stable_sort(indices.begin(), indices.end(), [&costs](const int a, const int b) {
+                return costs[a] > costs[b];
+            });
+            return indices;
+        };
+
+        // longest-processing-time first: workers greedily take the most expensive task left
+        static Report run(const std::vector<double>& costs, int workers, const std::function<void(const int)>& task) {
+            if (workers <= 0)
+                throw std::invalid_argument("Schedule::run: workers must be positive.");
+
+            const int size = costs.size();
+            Report report;
+            report.times.assign(size, 0);
+            if (size == 0)
+                return report;
+
+            workers = std::min(workers, size);
+
+            const std::vector<int> indices = order(costs);
+
+            // helpers may pick their copy up after every task is taken, so they only hold on to <state>;
+            // the caller runs tasks as well, which keeps nested runs going when every helper is busy
+            struct State {
+                std::atomic<int> next{ 0 };
+                int finished = 0;
+                std::exception_ptr error;
+                std::mutex mutex;
+                std::condition_variable done;
+            };
+            const auto state = std::make_shared<State>();
+
+            const auto start = std::chrono::steady_clock::now();
+            auto work = [state, size, indices = indices.data(), times = report.times.data(), &task]() {
+                for (int i = state->next++; i < size; i = state->next++) {
+                    const int index = indices[i];
+
+                    std::exception_ptr error;
+                    const auto begin = std::chrono::steady_clock::now();
+                    try {
+                        task(index);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    times[index] = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (error && !state->error)
+                        state->error = error;
+                    if (++state->finished == size)
+                        state->done.notify_all();
+                }
+            };
+
+            if (workers > 1)
+                pool().post(work, workers - 1);
+            work();
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->done.wait(lock, [&state, size]() { return state->finished == size; });
+            }
+            if (state->error)
+                std::rethrow_exception(state->error);
+
+            report.makespan = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const double total = std::accumulate(report.times.begin(), report.times.end(), 0.0);
+            const double longest = *std::max_element(report.times.begin(), report.times.end());
+            report.ideal = std::max(total / workers, longest);
+
+            return report;
+        };
+};
\ No newline at end of file
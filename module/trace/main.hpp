@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// scoped trace points, dumped as chrome/perfetto trace json
+// TRACE_SCOPE compiles to nothing unless TRACING is defined
+#ifdef TRACING
+#define TRACE_JOIN(a, b) a##b
+#define TRACE_NAME(line) TRACE_JOIN(trace_, line)
+#define TRACE_SCOPE(name) const Trace::Scope TRACE_NAME(__LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+class Trace {
+    private:
+        struct Event {
+            const char* name; // string literal, never copied
+            std::int64_t begin, end; // nanoseconds since the first trace point
+            int thread;
+        };
+        struct Chunk {
+            static constexpr int SIZE = 4096;
+            Event events[SIZE];
+            std::atomic<int> size{ 0 }; // published with release, events below it are complete
+            std::atomic<Chunk*> next{ nullptr };
+        };
+        struct Buffer { // written by the one thread owning it, read by dump() at any time
+            std::atomic<bool> owned{ true };
+            std::atomic<Chunk*> head{ nullptr };
+            Chunk* tail = nullptr;
+            std::atomic<Buffer*> next{ nullptr };
+        };
+        struct Owner { // hands the buffer back when its thread exits, so short-lived workers reuse buffers
+            Buffer* buffer = nullptr;
+            int thread = 0;
+            ~Owner() {
+                if (buffer != nullptr)
+                    buffer->owned.store(false, std::memory_order_release);
+            };
+        };
+
+        static std::atomic<Buffer*>& buffers() { static std::atomic<Buffer*> head{ nullptr }; return head; };
+        static std::atomic<bool>& active() { static std::atomic<bool> flag{ true }; return flag; };
+        static std::atomic<std::int64_t>& since() { static std::atomic<std::int64_t> time{ 0 }; return time; };
+        static std::atomic<int>& threads() { static std::atomic<int> count{ 0 }; return count; };
+        static std::mutex& readers() { static std::mutex mutex; return mutex; }; // held by dump() and by clear() while it frees chunks
+
+        static Owner& local() {
+            thread_local Owner owner;
+            if (owner.buffer != nullptr)
+                return owner;
+
+            owner.thread = threads().fetch_add(1) + 1;
+            for (Buffer* buffer = buffers().load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next.load(std::memory_order_acquire)) {
+                bool owned = false;
+                if (buffer->owned.compare_exchange_strong(owned, true, std::memory_order_acq_rel)) {
+                    owner.buffer = buffer;
+                    return owner;
+                }
+            }
+
+            Buffer* buffer = new Buffer(); // never freed, dump() may still be walking it
+            Buffer* head = buffers().load(std::memory_order_relaxed);
+            do
+                buffer->next.store(head, std::memory_order_relaxed);
+            while (!buffers().compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+            owner.buffer = buffer;
+            return owner;
+        };
+
+        static void escape(std::ofstream& out, const char* text) {
+            for (; *text != '\0'; text++)
+                if (*text == '"' || *text == '\\')
+                    out << '\\' << *text;
+                else
+                    out << *text;
+        };
+
+    public:
+        class Scope {
+            private:
+                const char* name;
+                std::int64_t begin;
+
+            public:
+                Scope(const char* n) : name(n), begin(active().load(std::memory_order_relaxed) ? now() : -1) { };
+                Scope(const Scope&) = delete;
+                ~Scope() {
+                    if (begin >= 0)
+                        record(name, begin, now());
+                };
+
+                Scope& operator=(const Scope&) = delete;
+        };
+
+        static std::int64_t now() {
+            static const auto origin = std::chrono::steady_clock::now();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+        };
+
+        static bool enabled() { return active().load(); };
+        static void enable(const bool on = true) { active().store(on); };
+
+        static void record(const char* name, const std::int64_t begin, const std::int64_t end) { // lock-free, allocates a chunk every Chunk::SIZE events
+            Owner& owner = local();
+            Buffer& buffer = *owner.buffer;
+
+            Chunk* chunk = buffer.tail;
+            int size = chunk == nullptr ? Chunk::SIZE : chunk->size.load(std::memory_order_relaxed);
+            if (size == Chunk::SIZE) {
+                Chunk* fresh = new Chunk();
+                if (chunk == nullptr)
+                    buffer.head.store(fresh, std::memory_order_release);
+                else
+                    chunk->next.store(fresh, std::memory_order_release);
+                buffer.tail = chunk = fresh;
+                size = 0;
+            }
+
+            chunk->events[size] = { name, begin, end, owner.thread };
+            chunk->size.store(size + 1, std::memory_order_release);
+        };
+
+        static void clear() { // later dumps leave out what was recorded so far, whose chunks are freed
+            std::lock_guard<std::mutex> lock(readers());
+            since().store(now());
+
+            // a chunk with a successor is full and its owner has moved on, only the tail is still written to
+            for (Buffer* buffer = buffers().load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next.load(std::memory_order_acquire))
+                for (Chunk* chunk = buffer->head.load(std::memory_order_acquire); chunk != nullptr; ) {
+                    Chunk* next = chunk->next.load(std::memory_order_acquire);
+                    if (next == nullptr)
+                        break;
+                    buffer->head.store(next, std::memory_order_release);
+                    delete chunk;
+                    chunk = next;
+                }
+        };
+
+        static std::size_t dump(const std::string& path) { // safe while other threads record, returns the events written
+            std::ofstream out(path);
+            if (!out)
+                throw std::runtime_error("Trace::dump: could not open "+path+".");
+
+            std::lock_guard<std::mutex> lock(readers());
+            const std::int64_t from = since().load();
+            std::size_t count = 0;
+
+            char number[64];
+            out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            for (Buffer* buffer = buffers().load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next.load(std::memory_order_acquire))
+                for (Chunk* chunk = buffer->head.load(std::memory_order_acquire); chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire)) {
+                    const int size = chunk->size.load(std::memory_order_acquire);
+                    for (int i = 0; i < size; i++) {
+                        const Event& event = chunk->events[i];
+                        if (event.begin < from)
+                            continue;
+
+                        out << (count++ == 0 ? "\n" : ",\n") << "{\"name\":\"";
+                        escape(out, event.name);
+                        std::snprintf(number, sizeof(number), "%.3f,\"dur\":%.3f", event.begin / 1e+3, (event.end - event.begin) / 1e+3);
+                        out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << number << "}";
+                    }
+                }
+            out << "\n]}\n";
+            return count;
+        };
+};
\ No newline at end of file
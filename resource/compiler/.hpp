@@ -11,6 +11,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "../../module/trace/main.hpp"
+
 class Compiler {
     private:
         std::filesystem::path dir;
@@ -63,6 +65,7 @@ class Compiler {
         };
 
         void compile(const std::string name, const std::string code, const bool keep = false) {
+            TRACE_SCOPE("Compiler::compile");
             const std::filesystem::path fileName = name;
             if (fileName.has_parent_path() || fileName.has_extension())
                 throw std::runtime_error("Compiler: invalid file name");
@@ -96,8 +99,33 @@ class Compiler {
             return compiled.find((dir / fileName).string()) != compiled.end();
         };
 
+        std::uintmax_t size(const std::string name) const { // bytes on disk, 0 when not compiled
+            const std::filesystem::path fileName = name;
+            if (fileName.has_parent_path() || fileName.has_extension())
+                throw std::runtime_error("Compiler: invalid file name");
+
+            std::filesystem::path file = std::filesystem::path(dir / fileName), cpp = file;
+            cpp.replace_extension(".cpp");
+
+            auto it = compiled.find(file.string());
+            if (it == compiled.end())
+                return 0;
+
+            std::error_code error;
+            std::uintmax_t bytes = std::filesystem::file_size(file, error);
+            if (error)
+                bytes = 0;
+            if (it->second == 1) {
+                const std::uintmax_t source = std::filesystem::file_size(cpp, error);
+                if (!error)
+                    bytes += source;
+            }
+            return bytes;
+        };
+
         template<typename T>
         std::vector<T> execute(const std::string name, const std::string args = "") const {
+            TRACE_SCOPE("Compiler::execute");
             const std::filesystem::path fileName = name;
             if (fileName.has_parent_path() || fileName.has_extension())
                 throw std::runtime_error("Compiler: invalid file name");
@@ -82,6 +82,12 @@ class Range {
             other._min = 0, other._max = 0, other._step = 0;
         };
 
+        Range<T>& operator=(const Range<T>& other) {
+            _min = other._min, _max = other._max, _step = other._step;
+            incMin = other.incMin, incMax = other.incMax;
+            return *this;
+        };
+
         T raw_min() const { return _min; };
         T raw_max() const { return _max; };
 
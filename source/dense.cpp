@@ -0,0 +1,128 @@
+#include "../header/dense.hpp"
+
+Dense::Dense(const Genome& genome, const ActivationFunction& fn) : activator(fn), sizes(), offsets(), weights(), biases(), links() {
+    const int depths = genome.get_size();
+    int total = 0;
+    for (int depth = 0; depth < depths; depth++) {
+        sizes.push_back(genome.get_size(depth));
+        offsets.push_back(total);
+        total += sizes.back();
+
+        weights.emplace_back(static_cast<std::size_t>(sizes[depth]) * offsets[depth], 0.0);
+        biases.emplace_back(sizes[depth], 0.0);
+        links.emplace_back(depth, 0);
+    }
+
+    const auto positions = genome.get_positions();
+    for (int depth = 0; depth < depths; depth++)
+        for (int height = 0; height < sizes[depth]; height++) {
+            const auto& neuron = genome.get_neuron(depth, height);
+            biases[depth][height] = neuron.bias;
+            for (const auto& synapse : neuron.synapses) {
+                const auto found = positions.find(synapse.source);
+                if (found == positions.end())
+                    continue;
+                const auto [ d, h ] = found->second;
+                set_weight(depth, height, d, h, synapse.weight);
+            }
+        }
+};
+
+int Dense::get_size() const { return offsets.empty() ? 0 : offsets.back() + sizes.back(); };
+std::size_t Dense::get_memory() const {
+    std::size_t bytes = sizeof(Dense) + (sizes.capacity() + offsets.capacity()) * sizeof(int);
+    for (std::size_t d = 0; d < sizes.size(); d++)
+        bytes += 3 * sizeof(std::vector<double>)
+            + (weights[d].capacity() + biases[d].capacity()) * sizeof(double) + links[d].capacity() * sizeof(int);
+    return bytes;
+};
+
+void Dense::set_bias(const int depth, const int height, const double bias) {
+    if (depth < 0 || depth >= static_cast<int>(sizes.size()) || height < 0 || height >= sizes[depth])
+        throw std::out_of_range("Dense::set_bias: invalid position.");
+    biases[depth][height] = bias;
+};
+void Dense::set_weight(const int depth, const int height, const int sourceDepth, const int sourceHeight, const double weight) {
+    if (depth < 0 || depth >= static_cast<int>(sizes.size()) || height < 0 || height >= sizes[depth])
+        throw std::out_of_range("Dense::set_weight: invalid position.");
+    if (sourceDepth < 0 || sourceDepth >= depth)
+        return;
+    if (sourceHeight < 0 || sourceHeight >= sizes[sourceDepth])
+        throw std::out_of_range("Dense::set_weight: invalid source.");
+
+    double& cell = weights[depth][static_cast<std::size_t>(height) * offsets[depth] + offsets[sourceDepth] + sourceHeight];
+    links[depth][sourceDepth] += (weight != 0) - (cell != 0);
+    cell = weight;
+};
+
+void Dense::run(const int depth, const int begin, const int end, std::vector<double>& values) const {
+    const int columns = offsets[depth];
+    const double* matrix = weights[depth].data();
+    const double* bias = biases[depth].data();
+    const double* in = values.data();
+    double* out = values.data() + columns;
+
+    // column ranges of the earlier layers that feed this one
+    std::vector<std::tuple<int, int>> spans;
+    for (int s = 0; s < depth; s++)
+        if (links[depth][s] > 0) {
+            if (!spans.empty() && std::get<1>(spans.back()) == offsets[s])
+                std::get<1>(spans.back()) = offsets[s] + sizes[s];
+            else
+                spans.push_back({ offsets[s], offsets[s] + sizes[s] });
+        }
+
+    int row = begin;
+    for (; row + BLOCK <= end; row += BLOCK) {
+        const double* w0 = matrix + static_cast<std::size_t>(row) * columns;
+        const double* w1 = w0 + columns;
+        const double* w2 = w1 + columns;
+        const double* w3 = w2 + columns;
+
+        double s0 = bias[row], s1 = bias[row + 1], s2 = bias[row + 2], s3 = bias[row + 3];
+        for (const auto& [ from, to ] : spans)
+            for (int c = from; c < to; c++) {
+                const double x = in[c];
+                s0 += w0[c] * x, s1 += w1[c] * x, s2 += w2[c] * x, s3 += w3[c] * x;
+            }
+
+        out[row] = activator(s0), out[row + 1] = activator(s1), out[row + 2] = activator(s2), out[row + 3] = activator(s3);
+    }
+    for (; row < end; row++) {
+        const double* w = matrix + static_cast<std::size_t>(row) * columns;
+        double sum = bias[row];
+        for (const auto& [ from, to ] : spans)
+            for (int c = from; c < to; c++)
+                sum += w[c] * in[c];
+        out[row] = activator(sum);
+    }
+};
+
+std::vector<double> Dense::evaluate(const std::vector<double>& inputs, const int threads, const int grain) const {
+    if (threads <= 0 || grain <= 0)
+        throw std::invalid_argument("Dense::evaluate: threads and grain must be positive.");
+    if (sizes.empty())
+        return { };
+
+    std::vector<double> values(get_size(), 0);
+    for (int h = 0; h < sizes[0]; h++)
+        values[h] = activator(biases[0][h] + (h < static_cast<int>(inputs.size()) ? inputs[h] : 0));
+
+    for (int depth = 1; depth < static_cast<int>(sizes.size()); depth++) {
+        const int size = sizes[depth];
+        const int chunks = std::min(threads, (size + grain - 1) / grain);
+        if (chunks <= 1) {
+            run(depth, 0, size, values);
+            continue;
+        }
+
+        // rows only read earlier layers, so the chunks are independent; chunk edges stay on a block boundary
+        const int width = ((size + chunks - 1) / chunks + BLOCK - 1) / BLOCK * BLOCK;
+        Schedule::run(std::vector<double>(chunks, 1.0), chunks, [&](const int chunk) {
+            run(depth, std::min(size, chunk * width), std::min(size, (chunk + 1) * width), values);
+        });
+    }
+
+    const int last = sizes.size() - 1;
+    return std::vector<double>(values.begin() + offsets[last], values.end());
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "../header/evaluator.hpp"
+
+Evaluator::Evaluator(const Genome& genome, const ActivationFunction& fn) : activator(fn), entries(), biases(), offsets(), columns(), weights(), levels(), outputs() {
+    struct Node {
+        int input, level;
+        double bias;
+        std::vector<std::tuple<int, double>> sources;
+    };
+    std::vector<Node> nodes; // in genome order, renumbered by level below
+    std::unordered_map<int, std::tuple<int, int>> index; // neuron id -> node, depth
+    std::vector<int> last; // nodes of the output layer
+
+    const int depthMax = genome.get_size() - 1;
+    for (int depth = 0; depth <= depthMax; depth++)
+        for (int height = 0; height < genome.get_size(depth); height++) {
+            const auto& neuron = genome.get_neuron(depth, height);
+            Node node{ depth == 0 ? height : -1, 0, neuron.bias, { } };
+
+            if (depth != 0)
+                for (const auto& synapse : neuron.synapses) {
+                    const auto found = index.find(synapse.source);
+                    if (found == index.end() || std::get<1>(found->second) >= depth) // not computed yet, reads as 0
+                        continue;
+
+                    const int n = std::get<0>(found->second);
+                    node.sources.push_back({ n, synapse.weight });
+                    node.level = std::max(node.level, nodes[n].level + 1);
+                }
+
+            const int n = nodes.size();
+            index.insert_or_assign(neuron.id, std::tuple<int, int>{ n, depth });
+            nodes.push_back(std::move(node));
+
+            if (depth == depthMax)
+                last.push_back(n);
+        }
+
+    // a counting sort by level, stable so rows keep genome order within a level
+    for (const auto& node : nodes) {
+        if (node.level + 2 > static_cast<int>(levels.size()))
+            levels.resize(node.level + 2, 0);
+        levels[node.level + 1]++;
+    }
+    std::partial_sum(levels.begin(), levels.end(), levels.begin());
+
+    std::vector<int> rows(nodes.size());
+    std::vector<int> next = levels; // next free row per level
+    for (std::size_t n = 0; n < nodes.size(); n++)
+        rows[n] = next[nodes[n].level]++;
+
+    std::vector<int> order(nodes.size());
+    for (std::size_t n = 0; n < nodes.size(); n++)
+        order[rows[n]] = n;
+
+    std::size_t synapses = 0;
+    for (const auto& node : nodes)
+        synapses += node.sources.size();
+    entries.reserve(nodes.size()), biases.reserve(nodes.size()), offsets.reserve(nodes.size() + 1);
+    columns.reserve(synapses), weights.reserve(synapses);
+    offsets.push_back(0);
+    for (const int n : order) {
+        const Node& node = nodes[n];
+        entries.push_back(node.input);
+        biases.push_back(node.bias);
+        for (const auto& [ source, weight ] : node.sources) {
+            columns.push_back(rows[source]);
+            weights.push_back(weight);
+        }
+        offsets.push_back(columns.size());
+    }
+
+    for (const int n : last)
+        outputs.push_back(rows[n]);
+};
+
+int Evaluator::get_size() const { return biases.size(); };
+int Evaluator::get_depth() const { return levels.empty() ? 0 : levels.size() - 1; };
+int Evaluator::get_width() const {
+    int width = 0;
+    for (std::size_t l = 0; l + 1 < levels.size(); l++)
+        width = std::max(width, levels[l + 1] - levels[l]);
+    return width;
+};
+int Evaluator::get_synapses() const { return columns.size(); };
+std::size_t Evaluator::get_memory() const {
+    return sizeof(Evaluator)
+        + (entries.capacity() + offsets.capacity() + columns.capacity() + levels.capacity() + outputs.capacity()) * sizeof(int)
+        + (biases.capacity() + weights.capacity()) * sizeof(double);
+};
+
+void Evaluator::run(const int begin, const int end, const std::vector<double>& inputs, std::vector<double>& values) const {
+    const double* in = values.data();
+    for (int row = begin; row < end; row++) {
+        double sum = biases[row];
+        if (entries[row] >= 0)
+            sum += inputs[entries[row]];
+
+        int k = offsets[row];
+        const int stop = offsets[row + 1];
+#if defined(__AVX2__) && defined(__FMA__)
+        if (stop - k >= GATHER) {
+            const __m256d zero = _mm256_setzero_pd(), all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+            __m256d acc = zero;
+            for (; k + 4 <= stop; k += 4) {
+                const __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns.data() + k));
+                acc = _mm256_fmadd_pd(_mm256_loadu_pd(weights.data() + k), _mm256_mask_i32gather_pd(zero, in, index, all, 8), acc);
+            }
+            __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+            half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+            sum += _mm_cvtsd_f64(half);
+        }
+#endif
+        for (; k < stop; k++)
+            sum += weights[k] * in[columns[k]];
+
+        values[row] = activator(sum);
+    }
+};
+
+std::vector<double> Evaluator::evaluate(const std::vector<double>& inputs, const int threads, const int grain) const {
+    if (threads <= 0 || grain <= 0)
+        throw std::invalid_argument("Evaluator::evaluate: threads and grain must be positive.");
+
+    std::vector<double> values(biases.size(), 0);
+    for (std::size_t l = 0; l + 1 < levels.size(); l++) {
+        const int first = levels[l], size = levels[l + 1] - first;
+        const int chunks = std::min(threads, (size + grain - 1) / grain);
+        if (chunks <= 1) {
+            run(first, first + size, inputs, values);
+            continue;
+        }
+
+        // rows within a level only read earlier levels, so the chunks are independent
+        const int width = (size + chunks - 1) / chunks;
+        Schedule::run(std::vector<double>(chunks, 1.0), chunks, [&](const int chunk) {
+            run(first + chunk * width, first + std::min(size, (chunk + 1) * width), inputs, values);
+        });
+    }
+
+    std::vector<double> output;
+    output.reserve(outputs.size());
+    for (const int row : outputs)
+        output.push_back(values[row]);
+    return output;
+};
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "../header/genome.hpp"
+
+std::atomic<std::uint64_t> Genome::allocated{ 0 };
+
+void Genome::count(const Layer& layer) { allocated.fetch_add(sizeof(Layer) + layer.capacity() * sizeof(Layer::value_type), std::memory_order_relaxed); };
+void Genome::count(const Neuron& neuron) { allocated.fetch_add(sizeof(Neuron) + neuron.synapses.capacity() * sizeof(Synapse), std::memory_order_relaxed); };
+
+Genome::Layer& Genome::edit(const int depth) {
+    auto& layer = layers[depth];
+    if (layer.use_count() > 1) { // shared with another copy
+        layer = std::make_shared<Layer>(*layer);
+        count(*layer);
+    }
+    return *layer;
+};
+Genome::Neuron& Genome::edit(const int depth, const int height) {
+    auto& neuron = edit(depth)[height]; // a neuron only shows as shared once its layer is unshared
+    if (neuron.use_count() > 1) {
+        neuron = std::make_shared<Neuron>(*neuron);
+        count(*neuron);
+    }
+    return *neuron;
+};
+
+void Genome::check(const int depth, const int height) const {
+    if (depth < 0 || depth >= get_size() || height < 0 || height >= get_size(depth))
+        throw std::out_of_range("Genome: neuron out of range.");
+};
+void Genome::unlink(const std::unordered_set<int>& ids) {
+    // scans every synapse, but only copies the neurons that lose one
+    for (int depth = 0; depth < get_size(); depth++)
+        for (int height = 0; height < get_size(depth); height++) {
+            const auto& synapses = get_neuron(depth, height).synapses;
+            bool found = false;
+            for (const auto& synapse : synapses)
+                found |= ids.count(synapse.source) > 0;
+            if (!found)
+                continue;
+
+            auto& edited = edit(depth, height).synapses;
+            std::erase_if(edited, [&ids](const Synapse& synapse) { return ids.count(synapse.source) > 0; });
+        }
+};
+
+std::uint64_t Genome::get_allocated() { return allocated.load(std::memory_order_relaxed); };
+
+int Genome::get_size() const { return layers.size(); };
+int Genome::get_size(const int depth) const { return layers.at(depth)->size(); };
+int Genome::get_neurons() const {
+    int count = 0;
+    for (const auto& layer : layers)
+        count += layer->size();
+    return count;
+};
+int Genome::get_synapses() const {
+    int count = 0;
+    for (const auto& layer : layers)
+        for (const auto& neuron : *layer)
+            count += neuron->synapses.size();
+    return count;
+};
+
+const Genome::Neuron& Genome::get_neuron(const int depth, const int height) const {
+    check(depth, height);
+    return *(*layers[depth])[height];
+};
+std::unordered_map<int, std::tuple<int, int>> Genome::get_positions() const {
+    std::unordered_map<int, std::tuple<int, int>> positions;
+    for (int depth = 0; depth < get_size(); depth++)
+        for (int height = 0; height < get_size(depth); height++)
+            positions.insert_or_assign((*layers[depth])[height]->id, std::tuple<int, int>{ depth, height });
+    return positions;
+};
+Genome::Memory Genome::get_memory() const {
+    Memory memory;
+    memory.total = sizeof(Genome) + layers.capacity() * sizeof(layers[0]);
+    memory.owned = memory.total;
+
+    for (const auto& layer : layers) {
+        const double share = 1.0 / layer.use_count();
+        const std::size_t bytes = sizeof(Layer) + layer->capacity() * sizeof(Layer::value_type);
+        memory.total += bytes, memory.owned += bytes * share;
+
+        for (const auto& neuron : *layer) {
+            const std::size_t bytes = sizeof(Neuron) + neuron->synapses.capacity() * sizeof(Synapse);
+            memory.total += bytes, memory.owned += bytes * share / neuron.use_count();
+        }
+    }
+    return memory;
+};
+
+void Genome::compact() {
+    for (auto& layer : layers)
+        if (layer.use_count() == 1)
+            for (auto& neuron : *layer)
+                if (neuron.use_count() == 1)
+                    neuron->synapses.shrink_to_fit();
+};
+void Genome::clear() {
+    layers.clear();
+    next = 0;
+};
+
+void Genome::add_layer(const int depth) {
+    if (depth < 0 || depth > get_size())
+        throw std::out_of_range("Genome::add_layer: depth out of range.");
+    layers.insert(layers.begin() + depth, std::make_shared<Layer>());
+    count(*layers[depth]);
+};
+void Genome::remove_layer(const int depth) {
+    if (depth < 0 || depth >= get_size())
+        throw std::out_of_range("Genome::remove_layer: depth out of range.");
+
+    std::unordered_set<int> ids;
+    for (const auto& neuron : *layers[depth])
+        ids.insert(neuron->id);
+
+    layers.erase(layers.begin() + depth);
+    unlink(ids);
+};
+
+int Genome::add_neuron(const int depth, const int height, const double bias) {
+    if (depth < 0 || depth >= get_size() || height < 0 || height > get_size(depth))
+        throw std::out_of_range("Genome::add_neuron: position out of range.");
+
+    auto& layer = edit(depth);
+    layer.insert(layer.begin() + height, std::make_shared<Neuron>(Neuron{ next, bias, { } }));
+    count(*layer[height]);
+    return next++;
+};
+void Genome::remove_neuron(const int depth, const int height) {
+    check(depth, height);
+
+    const int id = get_neuron(depth, height).id;
+    auto& layer = edit(depth);
+    layer.erase(layer.begin() + height);
+    unlink({ id });
+};
+void Genome::set_bias(const int depth, const int height, const double bias) {
+    check(depth, height);
+    edit(depth, height).bias = bias;
+};
+
+void Genome::add_synapse(const int depth, const int height, const int source, const double weight) {
+    check(depth, height);
+    if (get_neuron(depth, height).id == source)
+        throw std::invalid_argument("Genome::add_synapse: cannot add synapse to itself.");
+
+    auto& synapses = edit(depth, height).synapses;
+    for (auto& synapse : synapses)
+        if (synapse.source == source) { // one synapse per source, re-adding replaces it
+            synapse.weight = weight;
+            return;
+        }
+    synapses.push_back({ source, weight });
+};
+void Genome::remove_synapse(const int depth, const int height, const int index) {
+    check(depth, height);
+    if (index < 0 || index >= static_cast<int>(get_neuron(depth, height).synapses.size()))
+        throw std::out_of_range("Genome::remove_synapse: index out of range.");
+
+    auto& synapses = edit(depth, height).synapses;
+    synapses.erase(synapses.begin() + index);
+};
+void Genome::set_weight(const int depth, const int height, const int index, const double weight) {
+    check(depth, height);
+    if (index < 0 || index >= static_cast<int>(get_neuron(depth, height).synapses.size()))
+        throw std::out_of_range("Genome::set_weight: index out of range.");
+
+    edit(depth, height).synapses[index].weight = weight;
+};
\ No newline at end of file
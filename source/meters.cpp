@@ -0,0 +1,26 @@
+#include "../header/meters.hpp"
+
+Meters::Meters(Metrics& metrics) :
+    compile(metrics.histogram("network_compile_seconds", "", "Network::compile wall time.", 1e-9)),
+    evaluation(metrics.histogram("network_evaluation_seconds", "", "One forward pass, interpreted or compiled.", 1e-9)),
+    sender(metrics.histogram("callback_seconds", "callback=\"sender\"", "User callback wall time.", 1e-9)),
+    trainer(metrics.histogram("callback_seconds", "callback=\"trainer\"", "", 1e-9)),
+    receiver(metrics.histogram("callback_seconds", "callback=\"receiver\"", "", 1e-9)),
+    compiles(metrics.counter("network_compiles_total", "", "Programs compiled.")),
+    hits(metrics.counter("fitness_cache_hits_total", "", "Evaluations skipped for a cached deterministic fitness.")),
+    evaluations(metrics.counter("network_evaluations_total", "", "Forward passes.")),
+    killed(metrics.counter("networks_killed_total", "", "Networks killed by racing, Population::kill or the memory budget.")),
+    pruned(metrics.counter("networks_pruned_total", "", "Networks pruned back under the memory budget.")),
+    mutations(),
+    allocated(metrics.counter("genome_allocated_bytes_total", "", "Bytes allocated for genome blocks by the process so far.")),
+    complexity(), memory() {
+        const char* kinds[] = { "add_layer", "remove_layer", "add_neuron", "remove_neuron", "bias", "add_synapse", "remove_synapse", "weight" };
+        for (const auto kind : kinds)
+            mutations.push_back(&metrics.counter("mutations_total", std::string("kind=\"")+kind+"\"", "Mutations applied by Network::evolve."));
+
+        for (const double q : { 0.0, 0.5, 0.9, 1.0 }) {
+            const std::string label = q == 0 ? "0" : q == 1 ? "1" : std::to_string(q).substr(0, 3);
+            complexity.push_back({ q, &metrics.gauge("network_complexity", "quantile=\""+label+"\"", "Neurons plus synapses per network, after the last generation.") });
+            memory.push_back({ q, &metrics.gauge("network_memory_bytes", "quantile=\""+label+"\"", "Bytes per network, shared genome blocks counted whole.") });
+        }
+    };
\ No newline at end of file
@@ -17,7 +17,38 @@ const Network::Group Network::get_group() const {
     const int size = scope.config.population.group;
     return { index / size, index % size };
 };
-int Network::get_size() const { return scope.layers.size(); };
+int Network::get_size() const { return genome.get_size(); };
+int Network::get_complexity() const { return genome.get_neurons() + genome.get_synapses(); };
+Network::Memory Network::memory() const {
+    Memory memory;
+
+    const auto blocks = genome.get_memory();
+    memory.genome = blocks.total, memory.owned = blocks.owned;
+
+    const std::size_t link = 2 * sizeof(void*); // list node overhead
+    memory.scope = scope.layers.size() * (sizeof(Layer*) + link + sizeof(Layer)) + footprint(scope.neurons);
+    for (const auto& [ layer, neurons ] : scope.neurons) {
+        memory.scope += neurons.size() * (sizeof(Neuron*) + link + sizeof(Neuron));
+        for (const auto neuron : neurons)
+            memory.sets += footprint(neuron->inlet) + footprint(neuron->outlet);
+    }
+
+    memory.scope += footprint(scope.synapses.list) + footprint(scope.synapses.source) + footprint(scope.synapses.target);
+    for (const auto& [ neuron, synapses ] : scope.synapses.list)
+        memory.scope += synapses.size() * (sizeof(Synapse*) + link + sizeof(Synapse));
+    for (const auto& [ neuron, synapses ] : scope.synapses.source)
+        memory.scope += footprint(synapses);
+    for (const auto& [ neuron, synapses ] : scope.synapses.target)
+        memory.scope += footprint(synapses);
+
+    memory.evaluator = evaluator ? evaluator->get_memory() : 0;
+    memory.evaluator += dense.has_value() ? dense->get_memory() : 0;
+    memory.compiled = compiler.size("network-"+std::to_string(id));
+    return memory;
+};
+
+double Network::get_elapsed() const { return elapsed; };
+void Network::set_elapsed(const double seconds) { elapsed = seconds; };
 
 Network::Status Network::get_status() const { return status; };
 void Network::set_status(const Status s) { status = s; };
@@ -31,6 +62,38 @@ double Network::get_fitness() const {
             fitness.sum;
 };
 
+double Network::get_variance() const {
+    if (fitness.count < 2)
+        return 0;
+    return fitness.m2 / (fitness.count - 1);
+};
+const Network::Bounds Network::get_bounds(const double z) const {
+    if (fitness.count == 0)
+        return { 0, 0 };
+
+    const double margin = z * std::sqrt(get_variance() / fitness.count);
+    return { fitness.mean - margin, fitness.mean + margin };
+};
+
+bool Network::is_modified() const { return modified; };
+bool Network::is_cached() const { return !modified && scope.config.network.fitness.deterministic; };
+
+int Network::get_parent() const { return parent; };
+const std::vector<Network::Mutation>& Network::get_journal() const { return journal; };
+void Network::detach() {
+    parent = -1;
+    detached = true;
+};
+
+const Genome& Network::get_genome() const { return genome; };
+void Network::set_genome(Genome g) {
+    genome = std::move(g);
+    stale = true;
+    modified = true;
+    evaluator.reset();
+    dense.reset();
+};
+
 Layer Network::add_layer(const int d) const {
     Layer layer(population, *this, scope);
     layer.set_depth(d);
@@ -42,119 +105,312 @@ Layer Network::add_layer(const int d) const {
 void Network::clear() {
     for (auto layer : scope.layers)
         layer->destruct();
+    scope.layers.clear();
+    genome.clear();
+    stale = false;
     fitness = {0, 0};
+    modified = true;
+    elapsed = 0;
+    evaluator.reset();
+    dense.reset();
+
+    parent = -1;
+    detached = false;
+    journal.clear();
 };
 void Network::init() {
     clear();
 
     const int inputs = scope.config.network.inputs, outputs = scope.config.network.outputs;
+    const auto& bias = scope.config.neuron.bias;
 
-    int i = 0;
-    Layer inputLayer = add_layer(i++);
-    for (int j = 0; j < inputs; j++)
-        inputLayer.add_neuron(j);
-
+    std::vector<int> sizes{ inputs };
     const auto& hidden = scope.config.network.hidden.value_or(std::vector<int>{});
-    for (const int h : hidden) {
-        Layer layer = add_layer(i++);
-        for (int j = 0; j < h; j++)
-            layer.add_neuron(j);
-    }
+    sizes.insert(sizes.end(), hidden.begin(), hidden.end());
+    sizes.push_back(outputs);
 
-    Layer outputLayer = add_layer(i++);
-    for (int j = 0; j < outputs; j++)
-        outputLayer.add_neuron(j);
+    for (int depth = 0; depth < static_cast<int>(sizes.size()); depth++) {
+        genome.add_layer(depth);
+        for (int height = 0; height < sizes[depth]; height++)
+            genome.add_neuron(depth, height, Random::generate<double>(bias));
+    }
+    stale = true;
 };
 void Network::clone_from(const Network& other) {
     clear();
-    for (const auto layer : other.scope.layers) {
-        Layer newLayer = add_layer(layer->get_depth());
-        for (const auto neuron : other.scope.neurons[layer]) {
-            Neuron newNeuron = newLayer.add_neuron(neuron->get_height());
-            newNeuron.set_bias(neuron->get_bias());
-
-            for (const auto [ source, synapse ] : other.scope.synapses.source[neuron]) {
-                const auto neurons = scope.neurons[*std::next(scope.layers.begin(), source->get_depth())];
-                Synapse newSynapse = newNeuron.add_synapse(**std::next(neurons.begin(), source->get_height()));
-                newSynapse.set_weight(synapse->get_weight());
-            }
-        }
-    }
+    genome = other.genome; // shares every layer and neuron until one side mutates it
+    stale = true;
+
+    // only a complete score carries over: racing, kills and budgets leave dead networks with partial sums,
+    // and a clone that inherited one would count as a cache hit and never be evaluated again
+    const bool scored = other.status == Alive && other.fitness.count > 0;
+    fitness = scored ? other.fitness : Fitness{ 0, 0 };
+    modified = !scored;
+    elapsed = other.elapsed;
+    evaluator = other.evaluator;
+    dense = other.dense; // one copy of contiguous storage, cheaper than rebuilding it from the genome
+
+    parent = other.detached ? -1 : other.index; // a detached parent differs from its last checkpoint
+};
+std::map<int, int> Network::tally(const int size, const double rate) {
+    // skip-sampled Random::log draws: an element is hit with <rate>, and each further repeat again with <rate>
+    std::map<int, int> counts;
+    for (const auto index : Random::sample(size, rate))
+        counts[index] = 1 + Random::skip(1 - rate);
+    return counts;
 };
 void Network::evolve() {
+    const auto& mutate = scope.config.mutate;
+    const std::size_t first = journal.size();
     const bool dynamic = !scope.config.network.hidden.has_value();
 
-    auto& layers = scope.layers;
     if (dynamic) {
-        int delta = Random::log<int>(scope.config.mutate.layer.add.rate) - Random::log<int>(scope.config.mutate.layer.remove.rate);
+        int delta = Random::log<int>(mutate.layer.add.rate) - Random::log<int>(mutate.layer.remove.rate);
         if (delta > 0) {
-            int size = layers.size();
-            for (int i = 0; i < delta; i++)
-                add_layer(Random::generate<int>(Range<int>(0, size++ - 1, false, false)));
+            for (int i = 0; i < delta; i++) { // anywhere after the inputs, up to just before the outputs
+                const int depth = Random::generate<int>(Range<int>(1, genome.get_size() - 1));
+                genome.add_layer(depth);
+                journal.push_back({ Mutation::AddLayer, depth });
+            }
+            modified = true;
         } else if (delta < 0) {
-            delta = std::min(-delta, static_cast<int>(layers.size() - 2));
-            for (int i = 0; i < delta; i++)
-                Random::pick(layers, 1, 1)->destruct();
+            delta = std::min(-delta, genome.get_size() - 2);
+            for (int i = 0; i < delta; i++) {
+                const int depth = Random::generate<int>(Range<int>(0, genome.get_size() - 1, false, false));
+                genome.remove_layer(depth);
+                journal.push_back({ Mutation::RemoveLayer, depth });
+            }
+            modified |= delta > 0;
         }
     }
 
-    int depth = 0;
-    const int depthMax = layers.size() - 1;
-    for (auto layer : layers) {
-        auto neurons = scope.neurons[layer];
-        if (dynamic && (depth != 0 || depth != depthMax)) {
-            int delta = Random::log<int>(scope.config.mutate.neuron.add.rate) - Random::log<int>(scope.config.mutate.neuron.remove.rate);
+    const int depthMax = genome.get_size() - 1;
+
+    if (dynamic && depthMax > 1) { // neuron counts are drawn once per network, over the hidden layers
+        std::map<int, int> deltas;
+        for (const auto [ index, count ] : tally(depthMax - 1, mutate.neuron.add.rate))
+            deltas[index + 1] += count;
+        for (const auto [ index, count ] : tally(depthMax - 1, mutate.neuron.remove.rate))
+            deltas[index + 1] -= count;
+
+        for (auto [ depth, delta ] : deltas) {
             if (delta > 0) {
-                int size = neurons.size();
-                for (int i = 0; i < delta; i++)
-                    layer->add_neuron(Random::generate<int>(Range<int>(0, size++, true, false)));
+                for (int i = 0; i < delta; i++) {
+                    const int height = Random::generate<int>(Range<int>(0, genome.get_size(depth) + 1, true, false));
+                    const double bias = Random::generate<double>(scope.config.neuron.bias);
+                    genome.add_neuron(depth, height, bias);
+                    journal.push_back({ Mutation::AddNeuron, depth, height, 0, 0, bias });
+                }
+                modified = true;
             } else if (delta < 0) {
-                delta = std::min(-delta, (int)neurons.size());
-                for (int i = 0; i < delta; i++)
-                    Random::pick(neurons)->destruct(false);
+                delta = std::min(-delta, genome.get_size(depth));
+                for (int i = 0; i < delta; i++) {
+                    const int height = Random::generate<int>(Range<int>(0, genome.get_size(depth), true, false));
+                    genome.remove_neuron(depth, height);
+                    journal.push_back({ Mutation::RemoveNeuron, depth, height });
+                }
+                modified |= delta > 0;
             }
         }
+    }
 
-        depth++;
-
-        auto otherLayers = layers;
-        otherLayers.remove(layer);
+    std::vector<int> depths, heights;
+    std::unordered_map<int, int> positions; // neuron id -> index, synapse mutations leave neuron positions alone
+    for (int depth = 0; depth <= depthMax; depth++)
+        for (int height = 0; height < genome.get_size(depth); height++) {
+            positions.insert_or_assign(genome.get_neuron(depth, height).id, depths.size());
+            depths.push_back(depth);
+            heights.push_back(height);
+        }
+    auto note = [&](const Mutation::Kind kind, const int target, const int source, const double value, const double previous = 0) {
+        const int at = positions.at(source);
+        journal.push_back({ kind, depths[target], heights[target], depths[at], heights[at], value, previous });
+    };
+
+    const int size = depths.size();
+    const auto biases = Random::sample(size, mutate.neuron.change.rate);
+    if (!biases.empty()) {
+        std::vector<double> amounts(biases.size());
+        Random::fill(amounts, Range<double>(mutate.neuron.change.amount));
+
+        for (size_t i = 0; i < biases.size(); i++) {
+            const int depth = depths[biases[i]], height = heights[biases[i]];
+            const double previous = genome.get_neuron(depth, height).bias;
+            const double bias = math::clamp(previous + amounts[i], scope.config.neuron.bias);
+            genome.set_bias(depth, height, bias);
+            journal.push_back({ Mutation::Bias, depth, height, 0, 0, bias, previous });
+        }
+        modified = true;
+    }
 
-        int height = 0;
-        for (auto neuron : neurons) {
-            if (Random::condition(scope.config.mutate.neuron.change.rate)) {
-                double amount = scope.config.mutate.neuron.change.amount;
-                neuron->mod_bias(Random::generate(amount));
-            }
+    if (depthMax > 0) {
+        std::map<int, int> deltas;
+        for (const auto [ index, count ] : tally(size, mutate.synapse.add.rate))
+            deltas[index] += count;
+        for (const auto [ index, count ] : tally(size, mutate.synapse.remove.rate))
+            deltas[index] -= count;
 
-            int delta = Random::log<int>(scope.config.mutate.synapse.add.rate) - Random::log<int>(scope.config.mutate.synapse.remove.rate);
+        for (auto [ index, delta ] : deltas) {
+            const int depth = depths[index], height = heights[index];
             if (delta > 0) {
-                int size = otherLayers.size();
                 for (int i = 0; i < delta; i++) {
-                    auto targetNeurons = scope.neurons[Random::pick(otherLayers)];
-                    neuron->add_synapse(*Random::pick(targetNeurons));
+                    int d = Random::generate<int>(Range<int>(0, depthMax, true, false)); // any other layer
+                    if (d >= depth)
+                        d++;
+
+                    const int count = genome.get_size(d);
+                    if (count == 0)
+                        continue;
+
+                    const int source = genome.get_neuron(d, Random::generate<int>(Range<int>(0, count, true, false))).id;
+                    const double weight = Random::generate<double>(scope.config.synapse.weight);
+                    genome.add_synapse(depth, height, source, weight);
+                    note(Mutation::AddSynapse, index, source, weight);
+                    modified = true;
                 }
             } else if (delta < 0) {
-                auto synapses = scope.synapses.list[neuron];
-                delta = std::min(-delta, (int)synapses.size());
-                for (int i = 0; i < delta; i++)
-                    Random::pick(synapses)->destruct(neuron);
+                delta = std::min(-delta, static_cast<int>(genome.get_neuron(depth, height).synapses.size()));
+                for (int i = 0; i < delta; i++) {
+                    const auto& synapses = genome.get_neuron(depth, height).synapses;
+                    const int at = Random::generate<int>(Range<int>(0, synapses.size(), true, false));
+                    note(Mutation::RemoveSynapse, index, synapses[at].source, 0);
+                    genome.remove_synapse(depth, height, at);
+                }
+                modified |= delta > 0;
             }
+        }
+    }
 
-            if (depth != 0) {
-                auto sources = scope.synapses.source[neuron];
-                for (auto [ source, synapse ] : sources) {
-                    if (Random::condition(scope.config.mutate.synapse.change.rate)) {
-                        double amount = scope.config.mutate.synapse.change.amount;
-                        synapse->mod_weight(Random::generate(amount));
-                    }
-                }
+    std::vector<std::tuple<int, int>> synapses; // neuron index, synapse index
+    for (int index = 0; index < size; index++) {
+        const int count = genome.get_neuron(depths[index], heights[index]).synapses.size();
+        for (int i = 0; i < count; i++)
+            synapses.push_back({ index, i });
+    }
+
+    const auto weights = Random::sample(synapses.size(), mutate.synapse.change.rate);
+    if (!weights.empty()) {
+        std::vector<double> amounts(weights.size());
+        Random::fill(amounts, Range<double>(mutate.synapse.change.amount));
+
+        for (size_t i = 0; i < weights.size(); i++) {
+            const auto [ index, at ] = synapses[weights[i]];
+            const int depth = depths[index], height = heights[index];
+            const auto synapse = genome.get_neuron(depth, height).synapses[at];
+            const double weight = math::clamp(synapse.weight + amounts[i], scope.config.synapse.weight);
+            genome.set_weight(depth, height, at, weight);
+            note(Mutation::Weight, index, synapse.source, weight, synapse.weight);
+        }
+        modified = true;
+    }
+
+    for (auto m = journal.begin() + first; m != journal.end(); m++)
+        scope.meters.mutations[m->kind]->add();
+
+    if (!is_cached())
+        fitness = {0, 0};
+    stale |= modified;
+    if (journal.size() > first) // an unmutated clone keeps the program it shares with its parent
+        evaluator.reset();
+
+    if (dense.has_value()) // only biases and synapses change in a fixed topology
+        for (auto m = journal.begin() + first; m != journal.end(); m++)
+            switch (m->kind) {
+                case Mutation::Bias:
+                    dense->set_bias(m->depth, m->height, m->value);
+                    break;
+                case Mutation::AddSynapse:
+                case Mutation::Weight:
+                    dense->set_weight(m->depth, m->height, m->sourceDepth, m->sourceHeight, m->value);
+                    break;
+                case Mutation::RemoveSynapse:
+                    dense->set_weight(m->depth, m->height, m->sourceDepth, m->sourceHeight, 0);
+                    break;
+                default:
+                    dense.reset();
+                    return;
             }
+};
+
+bool Network::prune(const std::size_t bytes) {
+    // in-memory caches go first, then the weakest synapses; false when the network still does not fit
+    // the compiled program is on disk and stays, or every compiled network would rebuild it each generation
+    if (memory().total() <= bytes)
+        return true;
+
+    for (auto layer : scope.layers)
+        layer->destruct();
+    scope.layers.clear();
+    stale = true;
+    evaluator.reset();
+    dense.reset();
+
+    const std::size_t size = memory().total();
+    if (size <= bytes)
+        return true;
+
+    std::vector<std::tuple<double, int, int, int>> synapses; // |weight|, depth, height, index
+    for (int depth = 0; depth < genome.get_size(); depth++)
+        for (int height = 0; height < genome.get_size(depth); height++) {
+            const auto& list = genome.get_neuron(depth, height).synapses;
+            for (int i = 0; i < static_cast<int>(list.size()); i++)
+                synapses.push_back({ std::abs(list[i].weight), depth, height, i });
         }
+
+    const std::size_t count = std::min(synapses.size(), (size - bytes + sizeof(Genome::Synapse) - 1) / sizeof(Genome::Synapse));
+    if (count == 0)
+        return false;
+
+    std::partial_sort(synapses.begin(), synapses.begin() + count, synapses.end());
+    synapses.resize(count);
+    std::sort(synapses.begin(), synapses.end(), [](const auto& a, const auto& b) { // later indices first, so earlier ones stay put
+        return std::tie(std::get<1>(a), std::get<2>(a), std::get<3>(b)) < std::tie(std::get<1>(b), std::get<2>(b), std::get<3>(a));
+    });
+
+    const auto positions = genome.get_positions();
+    for (const auto& [ weight, depth, height, index ] : synapses) {
+        const auto [ d, h ] = positions.at(genome.get_neuron(depth, height).synapses[index].source);
+        genome.remove_synapse(depth, height, index);
+        journal.push_back({ Mutation::RemoveSynapse, depth, height, d, h });
     }
+    genome.compact();
+
+    modified = true;
+    if (!is_cached())
+        fitness = {0, 0};
+    return memory().total() <= bytes;
 };
 
 void Network::prime() const {
+    if (stale) { // the pointer graph is only built for code generation, from the genome
+        for (auto layer : scope.layers)
+            layer->destruct();
+        scope.layers.clear();
+
+        for (int depth = 0; depth < genome.get_size(); depth++) {
+            Layer layer = add_layer(depth);
+            for (int height = 0; height < genome.get_size(depth); height++)
+                layer.add_neuron(height);
+        }
+
+        std::vector<std::vector<Neuron*>> grid;
+        for (const auto layer : scope.layers)
+            grid.emplace_back(scope.neurons[layer].begin(), scope.neurons[layer].end());
+
+        const auto positions = genome.get_positions();
+        for (int depth = 0; depth < genome.get_size(); depth++)
+            for (int height = 0; height < genome.get_size(depth); height++) {
+                const auto& neuron = genome.get_neuron(depth, height);
+                grid[depth][height]->set_bias(neuron.bias);
+                for (const auto& synapse : neuron.synapses) {
+                    const auto [ d, h ] = positions.at(synapse.source);
+                    Synapse added = grid[depth][height]->add_synapse(*grid[d][h]);
+                    added.set_weight(synapse.weight);
+                }
+            }
+        stale = false;
+    }
+
     int depth = 0;
     for (auto layer : scope.layers) {
         layer->set_depth(depth++);
@@ -210,6 +466,10 @@ std::string Network::get_code() const {
             "}";
 };
 std::string Network::compile(const bool debug) const {
+    TRACE_SCOPE("Network::compile");
+    const auto timer = scope.meters.compile.time();
+    scope.meters.compiles.add();
+    prime();
     update(InletOutlet);
 
     const std::string name = "network-"+std::to_string(id);
@@ -217,27 +477,71 @@ std::string Network::compile(const bool debug) const {
 
     return name;
 };
-void Network::input(const std::vector<double>& inputs) {
+const Dense& Network::get_dense() {
+    if (!scope.config.network.hidden.has_value())
+        throw std::runtime_error("Network::get_dense: topology is not fixed.");
+    if (!dense.has_value())
+        dense.emplace(genome, activator.function);
+    return *dense;
+};
+double Network::input(const std::vector<double>& inputs, const int threads) {
+    TRACE_SCOPE("Network::input");
     if (inputs.size() != scope.config.network.inputs)
         throw std::invalid_argument("Network::input: invalid input size");
 
-    std::string args = "";
-    for (const auto& input : inputs)
-        args += args.empty() ? std::to_string(input) : " "+std::to_string(input);
-
-    const std::vector<double> output = compiler.execute<double>(std::to_string(id), args);
+    std::vector<double> output;
+    if (scope.config.network.backend == Configuration::Network::Interpreted && scope.config.network.hidden.has_value()) {
+        TRACE_SCOPE("Dense::evaluate");
+        const Dense& matrices = get_dense();
+        const auto timer = scope.meters.evaluation.time();
+        output = matrices.evaluate(inputs, threads, scope.config.population.parallel.grain);
+    } else if (scope.config.network.backend == Configuration::Network::Interpreted) {
+        TRACE_SCOPE("Evaluator::evaluate");
+        if (!evaluator)
+            evaluator = std::make_shared<const Evaluator>(genome, activator.function);
+        const auto timer = scope.meters.evaluation.time();
+        output = evaluator->evaluate(inputs, threads, scope.config.population.parallel.grain);
+    } else {
+        std::string args = "";
+        for (const auto& input : inputs)
+            args += args.empty() ? std::to_string(input) : " "+std::to_string(input);
+
+        const auto timer = scope.meters.evaluation.time();
+        output = compiler.execute<double>("network-"+std::to_string(id), args);
+    }
+    scope.meters.evaluations.add();
 
-    const double fit = trainer(get_group(), output);
+    return score(output);
+};
+double Network::score(const std::vector<double>& output) {
+    double fit;
+    {
+        TRACE_SCOPE("trainer");
+        const auto timer = scope.meters.trainer.time();
+        fit = trainer(get_group(), output);
+    }
     fitness.sum += fit, fitness.count++;
 
-    this->receiver(get_group(), output);
+    const double delta = fit - fitness.mean;
+    fitness.mean += delta / fitness.count;
+    fitness.m2 += delta * (fit - fitness.mean);
+
+    {
+        TRACE_SCOPE("receiver");
+        const auto timer = scope.meters.receiver.time();
+        this->receiver(get_group(), output);
+    }
+    return fit;
 };
 
 void Network::_import(const ImportExport data) {
     fitness = { data.fitSum, data.fitCount };
+    if (data.fitCount > 0)
+        fitness.mean = data.fitSum / data.fitCount;
+    status = data.status;
 };
 const Network::ImportExport Network::_export() const {
-    return { index, fitness };
+    return { index, fitness, status };
 };
 
 void Network::destruct() {
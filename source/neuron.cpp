@@ -112,6 +112,8 @@ const Neuron::ImportExport Neuron::_export() const {
 void Neuron::destruct(bool byLayer) {
     for (auto synapse : scope.synapses.list[this])
         synapse->destruct(this);
+    for (auto [ neuron, synapse ] : scope.synapses.target[this]) // synapses reading this neuron
+        synapse->destruct(this);
 
     scope.synapses.list.erase(this);
     scope.synapses.source.erase(this);
@@ -2,7 +2,7 @@
 
 Network Population::new_network(const int index) {
     return Network(
-        *this, NetworkScope(config),
+        *this, NetworkScope(config, meters),
         _activator.function, _activator.string,
         _trainer,
         _receiver,
@@ -16,12 +16,101 @@ Network Population::add_network(const int index) {
     return network;
 };
 
+int Population::workers() const {
+    const int threads = config.population.threads;
+    if (threads > 0)
+        return threads;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+};
+void Population::reseed(const int index, const int phase) const {
+    // stream per (seed, generation, phase, index), independent of which thread runs it
+    // phases: 0 start, -1 evolve, 1 + step train, with steps counted across the generation's train calls
+    if (!config.population.seed.has_value())
+        return;
+
+    const std::uint64_t generation = Random::hash(config.population.seed.value(), statistics.generation);
+    Random::stream(Random::hash(generation, phase), index);
+};
+double Population::weight(double fit, const double min, const double max) const {
+    if (max == min)
+        return 1.0;
+
+    if (config.network.fitness.inverse)
+        fit = max - fit + min * 2;
+    return math::map(fit, min, max, config.population.equality, 1.0);
+};
+void Population::evaluate(Network& network, const int iterations, const int threads) {
+    for (int i = 0; i < iterations; i++) {
+        std::vector<double> inputs;
+        {
+            TRACE_SCOPE("sender");
+            const auto timer = meters.sender.time();
+            inputs = _sender(network.get_group());
+        }
+        const double fit = network.input(inputs, threads);
+        if (tape != nullptr)
+            tape->add(network.get_index(), std::move(inputs), fit);
+    }
+};
+bool Population::record(const Network& network) { // true when it became an extreme, whose code annotate() fills in
+    const int size = networks.size();
+    const NetworkStat stat{ network.get_fitness(), "", statistics.evaluations };
+
+    const bool first = statistics.evaluations == 0, window = statistics.evaluations % size == 0;
+    bool extreme = false;
+    if (window || stat > statistics.best.gen)
+        statistics.best.gen = stat, extreme = true;
+    if (window || stat < statistics.worst.gen)
+        statistics.worst.gen = stat, extreme = true;
+
+    if (first || statistics.best.gen > statistics.best.all)
+        statistics.best.all = statistics.best.gen;
+    if (first || statistics.worst.gen < statistics.worst.all)
+        statistics.worst.all = statistics.worst.gen;
+
+    if (++statistics.evaluations % size == 0)
+        statistics.generation++;
+    return extreme;
+};
+void Population::annotate(const long long evaluation, const std::string& code) { // extremes still holding that evaluation
+    for (auto stat : { &statistics.best.all, &statistics.best.gen, &statistics.worst.all, &statistics.worst.gen })
+        if (stat->evaluation == evaluation)
+            stat->code = code;
+};
+
 Population::Status Population::status() const { return _status; };
 int Population::generation() const { return statistics.generation; };
+const Configuration& Population::configuration() const { return config; };
 
 int Population::size() const { return networks.size(); };
 int Population::alive() const { return statistics.alive; };
 int Population::dead() const { return statistics.dead; };
+long long Population::evaluations() const { return statistics.evaluations; };
+long long Population::saved() const { return statistics.saved; };
+Schedule::Report Population::makespan() const { return statistics.schedule; };
+
+Population::Memory Population::memory() const {
+    Memory memory;
+
+    std::vector<double> sizes;
+    for (const auto& network : networks) {
+        const auto m = network.memory();
+        memory.total += m.total() - m.genome + m.owned;
+        sizes.push_back(m.total());
+    }
+    if (sizes.empty())
+        return memory;
+
+    std::sort(sizes.begin(), sizes.end());
+    auto at = [&sizes](const double q) { return sizes[static_cast<std::size_t>(q * (sizes.size() - 1))]; };
+    memory.p50 = at(0.5), memory.p90 = at(0.9), memory.p99 = at(0.99), memory.max = sizes.back();
+    return memory;
+};
+Metrics::Snapshot Population::metrics() const {
+    meters.allocated.raise(Genome::get_allocated());
+    return monitor.snapshot();
+};
+void Population::metrics(const std::string path) const { metrics().write(path); };
 
 Population::NetworkStat Population::best(std::string type) const {
     if (type == "all")
@@ -43,6 +132,8 @@ Population::NetworkStat Population::worst(std::string type) const {
 void Population::activator(const std::string name, const std::vector<double> consts) {
     _activator.function = ActivatorSearch::function(name, consts);
     _activator.string = ActivatorSearch::string(name, consts);
+    _activator.name = name;
+    _activator.consts = consts;
 };
 void Population::trainer(FitnessFunction fn) { _trainer = fn; };
 void Population::sender(InputFunction fn) { _sender = fn; };
@@ -58,14 +149,16 @@ void Population::start() {
     networks.clear();
 
     const int size = config.population.size;
+    statistics = { 0, size, 0, { }, { } };
     for (int i = 0; i < size; i++) {
+        reseed(i);
         Network network = add_network(i);
         network.init();
         network.evolve();
-        network.prime();
     }
+    enforce();
+    measure();
 
-    statistics = { 0, size, 0, { }, { } };
     _status = ON;
 };
 void Population::pause() {
@@ -103,7 +196,7 @@ int Population::kill(Args... args) {
     const int size = config.population.size;
     const int groupSize = config.population.group, groupCount = size / groupSize;
 
-    std::vector<Network&> recovery = { };
+    std::vector<Network*> recovery = { };
     try {
         for (const auto& group : { args... }) {
             if (group.group < 0 || group.group >= groupCount)
@@ -114,28 +207,172 @@ int Population::kill(Args... args) {
             auto& network = networks[group.group * groupSize + group.index];
             if (network.get_status() == Network::Alive) {
                 network.set_status(Network::Dead);
-                recovery.push_back(network);
+                recovery.push_back(&network);
             }
         }
     } catch (...) {
-        for (auto& network : recovery)
-            network.set_status(Network::Alive);
+        for (auto network : recovery)
+            network->set_status(Network::Alive);
         throw std::runtime_error("Population::kill: failed to kill networks.");
     }
 
     const int count = recovery.size();
     statistics.alive -= count;
     statistics.dead += count;
+    meters.killed.add(count);
 
     return count;
 };
 
+int Population::race(const int remaining) {
+    const auto& racing = config.population.racing;
+    const bool inverse = config.network.fitness.inverse;
+
+    std::vector<Network*> contenders;
+    std::vector<double> lower;
+    for (auto& network : networks)
+        if (network.get_status() == Network::Alive) {
+            const auto bounds = network.get_bounds(racing.confidence);
+            contenders.push_back(&network);
+            lower.push_back(inverse ? -bounds.upper : bounds.lower);
+        }
+
+    const int count = contenders.size();
+    if (count < 2)
+        return 0;
+
+    const int rank = std::clamp(static_cast<int>(std::ceil(count * racing.cutoff)) - 1, 0, count - 1);
+
+    std::nth_element(lower.begin(), lower.begin() + rank, lower.end(), std::greater<double>());
+    const double cutoff = lower[rank];
+
+    int killed = 0;
+    for (auto network : contenders) {
+        const auto bounds = network->get_bounds(racing.confidence);
+        const double upper = inverse ? -bounds.lower : bounds.upper;
+        if (upper < cutoff)
+            killed += kill(network->get_group());
+    }
+
+    statistics.saved += static_cast<long long>(killed) * remaining;
+    return killed;
+};
+
+std::vector<double> Population::costs(const std::vector<Network*>& batch) const {
+    // measured time where available, otherwise network size scaled by the measured time per unit
+    double seconds = 0, units = 0;
+    for (const auto network : batch)
+        if (network->get_elapsed() > 0) {
+            seconds += network->get_elapsed();
+            units += network->get_complexity();
+        }
+    const double rate = units > 0 ? seconds / units : 1.0;
+
+    std::vector<double> costs;
+    costs.reserve(batch.size());
+    for (const auto network : batch) {
+        const double elapsed = network->get_elapsed();
+        costs.push_back(elapsed > 0 ? elapsed : network->get_complexity() * rate);
+    }
+    return costs;
+};
+void Population::measure() {
+    std::vector<int> sizes;
+    std::vector<std::size_t> bytes;
+    for (const auto& network : networks) {
+        sizes.push_back(network.get_complexity());
+        bytes.push_back(network.memory().total());
+    }
+    if (sizes.empty())
+        return;
+
+    std::sort(sizes.begin(), sizes.end());
+    std::sort(bytes.begin(), bytes.end());
+    for (const auto& [ q, gauge ] : meters.complexity)
+        gauge->set(sizes[static_cast<std::size_t>(q * (sizes.size() - 1))]);
+    for (const auto& [ q, gauge ] : meters.memory)
+        gauge->set(bytes[static_cast<std::size_t>(q * (bytes.size() - 1))]);
+};
+bool Population::within(Network& network) {
+    const auto& budget = config.network.budget;
+    if (budget.bytes == 0 || network.memory().total() <= budget.bytes)
+        return true;
+
+    if (budget.action == Configuration::Network::Budget::Prune && network.prune(budget.bytes)) {
+        meters.pruned.add();
+        return true;
+    }
+    return false;
+};
+void Population::enforce() { // networks over the memory budget are pruned or killed before they are evaluated
+    if (config.network.budget.bytes == 0)
+        return;
+
+    for (auto& network : networks)
+        if (network.get_status() == Network::Alive && !within(network))
+            kill(network.get_group());
+};
+void Population::step() {
+    TRACE_SCOPE("Population::step");
+    std::vector<Network*> batch;
+    int hits = 0;
+    for (auto& network : networks)
+        if (network.get_status() == Network::Status::Alive) {
+            if (network.is_cached())
+                hits++;
+            else
+                batch.push_back(&network);
+        }
+    meters.hits.add(hits);
+
+    const int size = batch.size(), count = workers();
+    const auto& parallel = config.population.parallel;
+
+    // inter-network: one worker per network; intra-network: every worker inside one network at a time
+    int outer = count;
+    std::vector<int> inner(size, 1);
+    if (config.network.backend == Configuration::Network::Interpreted)
+        for (int i = 0; i < size; i++)
+            switch (parallel.mode) {
+                case Configuration::Population::Parallel::Intra:
+                    outer = 1;
+                    inner[i] = count;
+                    break;
+                case Configuration::Population::Parallel::Auto:
+                    if (size < count && batch[i]->get_complexity() >= parallel.threshold)
+                        inner[i] = std::max(1, count / size);
+                    break;
+                case Configuration::Population::Parallel::Inter:
+                    break;
+            }
+
+    const int phase = 1 + statistics.steps++;
+    const Schedule::Report report = Schedule::run(costs(batch), outer, [&batch, &inner, phase, this](const int i) {
+        reseed(batch[i]->get_index(), phase);
+        evaluate(*batch[i], 1, inner[i]);
+    });
+
+    for (int i = 0; i < size; i++)
+        batch[i]->set_elapsed(report.times[i]);
+
+    statistics.schedule.makespan += report.makespan;
+    statistics.schedule.ideal += report.ideal;
+    statistics.evaluations += size;
+};
+
 void Population::train(int iterations, std::optional<int> interval) {
     if (_status != ON)
         throw std::runtime_error("Population: not started.");
     if (iterations <= 0)
         throw std::invalid_argument("Population::train: invalid iterations.");
 
+    const auto& racing = config.population.racing;
+    if (racing.enabled && racing.checkpoint <= 0)
+        throw std::invalid_argument("Population::train: invalid racing checkpoint.");
+
+    if (tape != nullptr)
+        tape->calls.push_back(iterations);
+
     _status = TRAINING;
     if (interval.has_value()) {
         const int t = interval.value();
@@ -146,53 +383,88 @@ void Population::train(int iterations, std::optional<int> interval) {
         for (int i = 0; i < iterations; i++) {
             std::this_thread::sleep_for(ms);
 
-            std::vector<std::thread> threads;
-            for (auto& network : networks) {
-                if (_status != TRAINING) {
-                    if (_status == PAUSED) {
-                        training = new std::promise<void>();
-                        training->get_future().wait();
-                    } else if (_status == OFF)
-                        return;
-                }
-
-                if (network.get_status() == Network::Status::Alive)
-                    threads.emplace_back([&network, this]() {
-                        network.input(_sender(network.get_group()));
-                    });
+            if (_status != TRAINING) {
+                if (_status == PAUSED) {
+                    training = new std::promise<void>();
+                    training->get_future().wait();
+                } else if (_status == OFF)
+                    return;
             }
 
-            for (auto& thread : threads)
-                if (thread.joinable())
-                    thread.join();
+            step();
+
+            if (racing.enabled && (i + 1) % racing.checkpoint == 0 && i + 1 < iterations)
+                race(iterations - i - 1);
         }
     } else
         for (int i = 0; i < iterations; i++) {
-            std::vector<std::thread> threads;
-            for (auto& network : networks) {
-                if (_status != TRAINING) {
-                    if (_status == PAUSED) {
-                        training = new std::promise<void>();
-                        training->get_future().wait();
-                    } else if (_status == OFF)
-                        return;
-                }
-
-                if (network.get_status() == Network::Status::Alive)
-                    threads.emplace_back([&network, this]() {
-                        network.input(_sender(network.get_group()));
-                    });
+            if (_status != TRAINING) {
+                if (_status == PAUSED) {
+                    training = new std::promise<void>();
+                    training->get_future().wait();
+                } else if (_status == OFF)
+                    return;
             }
 
-            for (auto& thread : threads)
-                if (thread.joinable())
-                    thread.join();
+            step();
+
+            if (racing.enabled && (i + 1) % racing.checkpoint == 0 && i + 1 < iterations)
+                race(iterations - i - 1);
         }
 
     _status = ON;
     return;
 };
+std::vector<double> Population::batch(const std::vector<std::vector<double>>& inputs) {
+    TRACE_SCOPE("Population::batch");
+    if (_status != ON)
+        throw std::runtime_error("Population: not started.");
+    if (!config.network.hidden.has_value())
+        throw std::runtime_error("Population::batch: needs a fixed topology.");
+    if (tape != nullptr) // the trainer runs on outputs the tape has no calls for, a replay would score differently
+        throw std::runtime_error("Population::batch: not supported while a Recorder is attached.");
+    if (inputs.empty())
+        throw std::invalid_argument("Population::batch: no inputs.");
+    for (const auto& input : inputs)
+        if (static_cast<int>(input.size()) != config.network.inputs)
+            throw std::invalid_argument("Population::batch: invalid input size.");
+
+    std::vector<Network*> batch;
+    std::vector<const Dense*> matrices;
+    int hits = 0;
+    for (auto& network : networks)
+        if (network.get_status() == Network::Alive) {
+            if (network.is_cached())
+                hits++;
+            else {
+                batch.push_back(&network);
+                matrices.push_back(&network.get_dense());
+            }
+        }
+    meters.hits.add(hits);
+
+    const int size = batch.size(), count = workers();
+    std::vector<std::vector<std::vector<double>>> outputs;
+    {
+        TRACE_SCOPE("Tensor::evaluate");
+        outputs = Tensor(matrices, _activator.function).evaluate(inputs, count);
+    }
+    meters.evaluations.add(static_cast<long long>(size) * inputs.size());
+
+    Schedule::run(std::vector<double>(size, 1.0), count, [&batch, &outputs](const int i) {
+        for (const auto& output : outputs[i])
+            batch[i]->score(output);
+    });
+    statistics.evaluations += static_cast<long long>(size) * inputs.size();
+
+    std::vector<double> fitness;
+    fitness.reserve(networks.size());
+    for (const auto& network : networks)
+        fitness.push_back(network.get_fitness());
+    return fitness;
+};
 void Population::evolve() {
+    TRACE_SCOPE("Population::evolve");
     if (_status != ON)
         throw std::runtime_error("Population: not started.");
 
@@ -228,10 +500,7 @@ void Population::evolve() {
 
     double weight = 0;
     for (auto& [ network, fit ] : fits) {
-        if (config.network.fitness.inverse)
-            fit = max - fit + min * 2;
-
-        double w = math::map(fit, min, max, config.population.equality, 1.0);
+        const double w = this->weight(fit, min, max);
 
         weight += w;
         fit = w;
@@ -239,41 +508,214 @@ void Population::evolve() {
 
     networker.erase(0x0);
 
-    std::unordered_map<Network&, std::vector<int>> picked = { };
-    const int size = config.population.size;
-    for (int i = 0; i < size; i++) {
-        double rng = Random::generate(0.0, weight);
-        for (auto& [ network, fit ] : fits) {
-            rng -= fit;
-            if (rng <= 0) {
-                picked[network].push_back(i);
-                break;
+    const int size = config.population.size, count = fits.size();
+    reseed(size, -1);
+
+    std::vector<int> parents(size, count - 1);
+    {
+        TRACE_SCOPE("Population::evolve/select");
+        for (int i = 0; i < size; i++) {
+            double rng = Random::generate(0.0, weight);
+            for (int j = 0; j < count; j++) {
+                rng -= std::get<1>(fits[j]);
+                if (rng <= 0) {
+                    parents[i] = j;
+                    break;
+                }
             }
         }
     }
 
-    std::vector<std::thread> threads;
-    std::vector<Network> newNetworks = { };
-    for (auto& [ network, indices ] : picked)
-        for (const auto& index : indices)
-            threads.emplace_back([&newNetworks, &network, index, this]() {
-                Network newNetwork = new_network(index);
-                newNetwork.clone_from(network);
-                newNetwork.evolve();
-                newNetwork.prime();
-                newNetworks.push_back(newNetwork);
-            });
-            
+    std::vector<double> costs;
+    for (const int parent : parents)
+        costs.push_back(networks[parent].get_complexity());
 
-    for (auto& thread : threads)
-        if (thread.joinable())
-            thread.join();
+    // children are stored by index, so the result does not depend on completion order
+    std::vector<std::optional<Network>> children(size);
+    Schedule::run(costs, workers(), [&children, &parents, this](const int index) {
+        reseed(index, -1);
+
+        Network& child = children[index].emplace(new_network(index));
+        {
+            TRACE_SCOPE("Network::clone_from");
+            child.clone_from(networks[parents[index]]);
+        }
+        TRACE_SCOPE("Network::evolve");
+        child.evolve();
+    });
 
-    networks = newNetworks;
+    networks.clear();
+    for (auto& child : children)
+        networks.push_back(*child);
 
     statistics.generation++;
+    statistics.steps = 0;
     statistics.alive = size;
     statistics.dead = 0;
+    statistics.saved = 0;
+    statistics.schedule = { };
+    enforce();
+    measure();
 
     return;
+};
+void Population::steady(const int evaluations, const int iterations) {
+    if (_status != ON)
+        throw std::runtime_error("Population: not started.");
+    if (evaluations <= 0)
+        throw std::invalid_argument("Population::steady: invalid evaluations.");
+    if (iterations <= 0)
+        throw std::invalid_argument("Population::steady: invalid iterations.");
+
+    _status = TRAINING;
+
+    const int size = networks.size();
+    const bool inverse = config.network.fitness.inverse;
+
+    std::vector<std::mutex> locks(size); // one per slot, held while a network is cloned into or evaluated
+    std::vector<char> busy(size, 0), evaluated(size, 0);
+    std::vector<double> fits(size, 0);
+
+    std::mutex selection; // guards the bookkeeping above, the queue and statistics
+    std::deque<int> pending;
+    for (int i = 0; i < size; i++)
+        if (networks[i].get_status() == Network::Alive)
+            pending.push_back(i);
+
+    int remaining = evaluations;
+    auto work = [&]() {
+        while (true) {
+            while (_status == PAUSED)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (_status == OFF)
+                return;
+
+            int slot = -1, parent = -1;
+            {
+                TRACE_SCOPE("Population::steady/select");
+                std::lock_guard<std::mutex> guard(selection);
+                if (remaining <= 0)
+                    return;
+
+                if (!pending.empty()) {
+                    slot = pending.front();
+                    pending.pop_front();
+                } else {
+                    double min = 0, max = 0;
+                    bool found = false;
+                    for (int i = 0; i < size; i++) {
+                        if (busy[i])
+                            continue;
+                        else if (!evaluated[i]) { // dead networks are replaced first
+                            slot = i;
+                            continue;
+                        }
+
+                        const double fit = fits[i];
+                        if (!found)
+                            min = max = fit, found = true;
+                        else
+                            min = std::min(min, fit), max = std::max(max, fit);
+
+                        if (slot == -1 || (evaluated[slot] && (inverse ? fit > fits[slot] : fit < fits[slot])))
+                            slot = i;
+                    }
+
+                    if (slot == -1) { // every slot is in flight
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    double total = 0;
+                    std::vector<std::tuple<int, double>> weights;
+                    for (int i = 0; i < size; i++)
+                        if (i != slot && evaluated[i] && !busy[i]) {
+                            const double w = weight(fits[i], min, max);
+                            weights.push_back({ i, w });
+                            total += w;
+                        }
+
+                    if (weights.empty()) { // no parent to replace <slot> with
+                        if (std::find(busy.begin(), busy.end(), 1) != busy.end()) { // one may come free, <slot> stays unclaimed
+                            std::this_thread::yield();
+                            continue;
+                        }
+                        if (!evaluated[slot]) // nothing alive is left to breed from
+                            return;
+                    }
+
+                    double rng = Random::generate(0.0, total);
+                    for (const auto& [ i, w ] : weights) {
+                        rng -= w;
+                        if (rng <= 0) {
+                            parent = i;
+                            break;
+                        }
+                    }
+                }
+
+                remaining--;
+                busy[slot] = 1;
+            }
+
+            if (parent != -1) {
+                TRACE_SCOPE("Population::steady/replace");
+                std::scoped_lock guard(locks[slot], locks[parent]);
+
+                Network& child = networks[slot];
+                child.clone_from(networks[parent]);
+                child.evolve();
+                child.detach(); // no longer matches the generation it would be journaled against
+
+                if (child.get_status() == Network::Dead) {
+                    child.set_status(Network::Alive);
+
+                    std::lock_guard<std::mutex> guard2(selection);
+                    statistics.alive++;
+                    statistics.dead--;
+                }
+
+                if (!within(child)) {
+                    std::lock_guard<std::mutex> guard2(selection);
+                    kill(child.get_group());
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(locks[slot]);
+            Network& network = networks[slot];
+            const bool alive = network.get_status() == Network::Alive;
+            if (alive && !network.is_cached())
+                evaluate(network, iterations);
+            else if (alive)
+                meters.hits.add();
+
+            long long at = -1;
+            {
+                std::lock_guard<std::mutex> guard2(selection);
+                fits[slot] = network.get_fitness();
+                evaluated[slot] = alive;
+                busy[slot] = 0;
+                if (alive && record(network))
+                    at = statistics.evaluations - 1;
+            }
+            if (at != -1) { // a new best or worst, its code is generated without blocking the other workers
+                const std::string code = network.get_code();
+                std::lock_guard<std::mutex> guard2(selection);
+                annotate(at, code);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const int count = workers();
+    for (int i = 0; i < count; i++)
+        threads.emplace_back(work);
+
+    for (auto& thread : threads)
+        if (thread.joinable())
+            thread.join();
+    measure();
+
+    if (_status == TRAINING)
+        _status = ON;
 };
\ No newline at end of file
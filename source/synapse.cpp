@@ -32,14 +32,14 @@ const Synapse::ImportExport Synapse::_export() const {
 };
 
 void Synapse::destruct(Neuron* by) {
+    // <source> owns the synapse and reads <target>; the maps of <by> are erased by the caller
     const auto targetPtr = &target, sourcePtr = &source;
-    if (by != targetPtr) {
-        scope.synapses.list[targetPtr].remove(this);
-        scope.synapses.source[targetPtr].erase(sourcePtr);
-    } else {
+    if (by != sourcePtr) {
         scope.synapses.list[sourcePtr].remove(this);
-        scope.synapses.target[sourcePtr].erase(targetPtr);
+        scope.synapses.source[sourcePtr].erase(targetPtr);
     }
+    if (by != targetPtr)
+        scope.synapses.target[targetPtr].erase(sourcePtr);
 
     scope.registry.erase(0x3, id);
     delete this;
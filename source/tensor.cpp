@@ -0,0 +1,129 @@
+#include "../header/tensor.hpp"
+
+Tensor::Tensor(const std::vector<const Dense*>& networks, const ActivationFunction& fn) :
+    activator(fn), count(networks.size()), sizes(), offsets(), weights(), biases(), links() {
+    if (networks.empty())
+        return;
+
+    sizes = networks.front()->sizes, offsets = networks.front()->offsets;
+    for (const auto network : networks)
+        if (network->sizes != sizes)
+            throw std::invalid_argument("Tensor: networks differ in shape.");
+
+    for (std::size_t depth = 0; depth < sizes.size(); depth++) {
+        auto& w = weights.emplace_back();
+        auto& b = biases.emplace_back();
+        auto& l = links.emplace_back();
+        w.reserve(static_cast<std::size_t>(count) * sizes[depth] * offsets[depth]);
+        b.reserve(static_cast<std::size_t>(count) * sizes[depth]);
+        l.reserve(static_cast<std::size_t>(count) * depth);
+
+        const int rows = sizes[depth], columns = offsets[depth];
+        for (const auto network : networks) {
+            const auto& matrix = network->weights[depth];
+            for (int c = 0; c < columns; c++) // transposed, a column's weights are contiguous across rows
+                for (int r = 0; r < rows; r++)
+                    w.push_back(matrix[static_cast<std::size_t>(r) * columns + c]);
+            b.insert(b.end(), network->biases[depth].begin(), network->biases[depth].end());
+            l.insert(l.end(), network->links[depth].begin(), network->links[depth].end());
+        }
+    }
+};
+
+int Tensor::get_count() const { return count; };
+int Tensor::get_size() const { return offsets.empty() ? 0 : offsets.back() + sizes.back(); };
+std::size_t Tensor::get_memory() const {
+    std::size_t bytes = sizeof(Tensor) + (sizes.capacity() + offsets.capacity()) * sizeof(int);
+    for (std::size_t d = 0; d < sizes.size(); d++)
+        bytes += 3 * sizeof(std::vector<double>)
+            + (weights[d].capacity() + biases[d].capacity()) * sizeof(double) + links[d].capacity() * sizeof(int);
+    return bytes;
+};
+
+void Tensor::run(const int network, const int depth, const int samples, std::vector<double>& values) const {
+    // one layer of one network over every sample: a (rows x columns) by (columns x samples) product, tiled;
+    // activations are [sample block][neuron][lane] and weights [column][row], so every column adds
+    // its weights, scaled by each sample's activation, into the tile: contiguous and free of reduction chains
+    const int rows = sizes[depth], columns = offsets[depth], total = get_size();
+    const double* matrix = weights[depth].data() + static_cast<std::size_t>(network) * rows * columns;
+    const double* bias = biases[depth].data() + static_cast<std::size_t>(network) * rows;
+    const int* link = links[depth].data() + static_cast<std::size_t>(network) * depth;
+
+    std::vector<std::tuple<int, int>> spans;
+    for (int s = 0; s < depth; s++)
+        if (link[s] > 0) {
+            if (!spans.empty() && std::get<1>(spans.back()) == offsets[s])
+                std::get<1>(spans.back()) = offsets[s] + sizes[s];
+            else
+                spans.push_back({ offsets[s], offsets[s] + sizes[s] });
+        }
+
+    double sums[LANES][TILE]; // [sample][row], rows contiguous like the weights they meet
+    for (int sample = 0; sample < samples; sample += LANES) {
+        double* block = values.data() + static_cast<std::size_t>(sample) * total;
+        for (int tile = 0; tile < rows; tile += TILE) {
+            const int height = std::min(TILE, rows - tile);
+            for (int j = 0; j < LANES; j++)
+                for (int r = 0; r < height; r++)
+                    sums[j][r] = bias[tile + r];
+
+            auto accumulate = [&](const int count) {
+                for (const auto& [ from, to ] : spans)
+                    for (int c = from; c < to; c++) {
+                        const double* x = block + static_cast<std::size_t>(c) * LANES;
+                        const double* w = matrix + static_cast<std::size_t>(c) * rows + tile;
+                        for (int j = 0; j < LANES; j++) {
+                            const double v = x[j];
+                            for (int r = 0; r < count; r++)
+                                sums[j][r] += w[r] * v;
+                        }
+                    }
+            };
+            if (height == TILE) // a constant trip count vectorizes at every optimization level
+                accumulate(TILE);
+            else
+                accumulate(height);
+
+            double* y = block + static_cast<std::size_t>(columns + tile) * LANES;
+            for (int r = 0; r < height; r++)
+                for (int j = 0; j < LANES; j++)
+                    y[r * LANES + j] = activator(sums[j][r]);
+        }
+    }
+};
+
+std::vector<std::vector<std::vector<double>>> Tensor::evaluate(const std::vector<std::vector<double>>& inputs, const int threads) const {
+    if (threads <= 0)
+        throw std::invalid_argument("Tensor::evaluate: threads must be positive.");
+    if (count == 0 || sizes.empty())
+        return std::vector<std::vector<std::vector<double>>>(count);
+
+    const int size = inputs.size(), total = get_size(), last = sizes.size() - 1;
+    const int samples = (size + LANES - 1) / LANES * LANES; // padded, the padding lanes run on zeros and are never read
+    for (const auto& input : inputs)
+        if (static_cast<int>(input.size()) != sizes[0])
+            throw std::invalid_argument("Tensor::evaluate: invalid input size.");
+
+    std::vector<std::vector<std::vector<double>>> outputs(count);
+    Schedule::run(std::vector<double>(count, 1.0), threads, [&](const int network) {
+        std::vector<double> values(static_cast<std::size_t>(total) * samples, 0); // [sample block][neuron][lane]
+        auto at = [total](const int neuron, const int sample) {
+            return (static_cast<std::size_t>(sample / LANES) * total + neuron) * LANES + sample % LANES;
+        };
+
+        const double* bias = biases[0].data() + static_cast<std::size_t>(network) * sizes[0];
+        for (int sample = 0; sample < size; sample++)
+            for (int h = 0; h < sizes[0]; h++)
+                values[at(h, sample)] = activator(bias[h] + inputs[sample][h]);
+
+        for (int depth = 1; depth <= last; depth++)
+            run(network, depth, samples, values);
+
+        auto& output = outputs[network];
+        output.assign(size, std::vector<double>(sizes[last]));
+        for (int o = 0; o < sizes[last]; o++)
+            for (int sample = 0; sample < size; sample++)
+                output[sample][o] = values[at(offsets[last] + o, sample)];
+    });
+    return outputs;
+};
\ No newline at end of file